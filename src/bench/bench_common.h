@@ -0,0 +1,50 @@
+// Shared helpers for the headless benchmarks: timer, seeded random numbers and regular polygons
+
+#ifndef SC2D_BENCH_COMMON_H
+#define SC2D_BENCH_COMMON_H
+
+#include <math.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static inline double now_seconds(void) {
+#ifdef _WIN32
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Fixed seed xorshift so runs are comparable
+static unsigned int rng_state = 0x2545F491u;
+
+static inline void random_seed(unsigned int seed) {
+	rng_state = seed ? seed : 0x2545F491u; // xorshift never leaves 0
+}
+
+static inline float random_float(float min, float max) {
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return min + (max - min) * (float)(rng_state & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+// Regular polygon as x/y pairs around the origin
+static inline void generate_polygon(float* verts, int count, float radius, float rotation) {
+	for (int i = 0; i < count; i++) {
+		float angle = rotation + 2.0f * 3.14159265f * i / count;
+		verts[i * 2]     = cosf(angle) * radius;
+		verts[i * 2 + 1] = sinf(angle) * radius;
+	}
+}
+
+#endif
@@ -0,0 +1,394 @@
+// Headless benchmark of every sc2d_check_* function on seeded random scenes of circles, rects and n-gons
+// Reports ns/test, tests/sec and per-sample percentiles for a hit-heavy and a miss-heavy mix, and can write JSON.
+//
+// Usage: sc2d_bench [--seed N] [--time SECONDS] [--filter TEXT] [--json FILE]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SIMPLE_COLLISION_2D_IMPLEMENTATION 1
+#include "../sc2d.h"
+
+#include "bench_common.h"
+
+#define TEST_COUNT 1024				// Tests per mix, cycled through while timing
+#define SAMPLE_SIZE 64				// Tests per timed sample, the unit of the percentiles
+#define MAX_SAMPLES 100000
+#define MAX_POLY_VERTS 32
+#define MANY_RADIUS 10.0f
+
+// Share of tests in each mix that are placed to overlap
+#define HIT_HEAVY_SHARE 0.9f
+#define MISS_HEAVY_SHARE 0.05f
+
+typedef struct Test {
+	float x1, y1, x2, y2;			// Centers
+	float r1, r2;					// Circle radii
+	float w1, h1, w2, h2;			// Rect sizes, centered on the test's centers
+	float verts1[MAX_POLY_VERTS * 2], verts2[MAX_POLY_VERTS * 2];
+	int count1, count2;
+	float radius1, radius2;			// Bounding radii for the _bounded checks
+	float storage1[MAX_POLY_VERTS * 4], storage2[MAX_POLY_VERTS * 4];
+	sc2d_poly poly1, poly2;
+	sc2d_shape shape1, shape2;		// Polygons for the GJK checks
+	sc2d_shape any1, any2;			// Circle, rect or polygon for sc2d_collide
+	sc2d_transform transform1, transform2;	// Centers and a random rotation of the polygons
+	sc2d_verts view1, view2;		// Strided views of the same vertices
+	sc2d_sat_cache cache;
+	sc2d_manifold manifold;			// Persists between runs, like a pair cache in a world step
+} Test;
+
+typedef struct Mix {
+	const char* name;
+	float hit_share;
+	Test tests[TEST_COUNT];
+	// Structure of arrays for the batch functions: side 1 at even indices, side 2 at odd ones
+	float circle_x[TEST_COUNT * 2], circle_y[TEST_COUNT * 2], circle_r[TEST_COUNT * 2];
+	float rect_x[TEST_COUNT * 2], rect_y[TEST_COUNT * 2], rect_w[TEST_COUNT * 2], rect_h[TEST_COUNT * 2];
+	sc2d_shape shapes[TEST_COUNT * 2];
+	sc2d_pair pairs[TEST_COUNT];
+	// Circles around the origin for sc2d_check_circle_many, placed against a query circle of MANY_RADIUS
+	float many_x[TEST_COUNT], many_y[TEST_COUNT], many_r[TEST_COUNT];
+} Mix;
+
+typedef struct Result {
+	const char* function;
+	const char* mix;
+	double ns_per_test, tests_per_sec, p50, p90, p99;
+	double hit_rate;
+} Result;
+
+static Mix mixes[2];
+static Mix* mix;					// Mix being timed
+static volatile float sink;			// Keeps the overlaps alive
+
+// Timed functions: run tests [first, first + count) of the current mix and return the number of hits
+
+#define BENCH_CHECK(name, call) \
+	static int name(int first, int count) { \
+		int hits = 0; \
+		float overlap_x = 0, overlap_y = 0, total = 0; \
+		for (int i = first; i < first + count; i++) { \
+			Test* t = mix->tests + i; \
+			(void)t; \
+			if (call) { \
+				hits++; \
+				total += overlap_x + overlap_y; \
+			} \
+		} \
+		sink += total; \
+		return hits; \
+	}
+
+#define BENCH_TEST(name, call) \
+	static int name(int first, int count) { \
+		int hits = 0; \
+		for (int i = first; i < first + count; i++) { \
+			Test* t = mix->tests + i; \
+			(void)t; \
+			hits += (call) ? 1 : 0; \
+		} \
+		return hits; \
+	}
+
+BENCH_CHECK(bench_point_circle, sc2d_check_point_circle(t->x1, t->y1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_point_rect, sc2d_check_point_rect(t->x1, t->y1, t->x2 - t->w2 / 2, t->y2 - t->h2 / 2, t->w2, t->h2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circles, sc2d_check_circles(t->x1, t->y1, t->r1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_rects, sc2d_check_rects(t->x1 - t->w1 / 2, t->y1 - t->h1 / 2, t->w1, t->h1, t->x2 - t->w2 / 2, t->y2 - t->h2 / 2, t->w2, t->h2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circle_centered_rect, sc2d_check_circle_centered_rect(t->x1, t->y1, t->r1, t->x2, t->y2, t->w2 / 2, t->h2 / 2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circle_rect, sc2d_check_circle_rect(t->x1, t->y1, t->r1, t->x2 - t->w2 / 2, t->y2 - t->h2 / 2, t->w2, t->h2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_poly2d, sc2d_check_poly2d(t->x1, t->y1, t->verts1, t->count1, t->x2, t->y2, t->verts2, t->count2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_poly2d_cached, sc2d_check_poly2d_cached(t->x1, t->y1, t->verts1, t->count1, t->x2, t->y2, t->verts2, t->count2, &t->cache, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circle_poly2d, sc2d_check_circle_poly2d(t->x1, t->y1, t->r1, t->x2, t->y2, t->verts2, t->count2, &overlap_x, &overlap_y))
+BENCH_TEST(bench_point_poly2d, sc2d_check_point_poly2d(t->x1 - t->x2, t->y1 - t->y2, t->verts2, t->count2))
+BENCH_TEST(bench_point_line, sc2d_check_point_line(t->x1, t->y1, t->x2 - t->w2 / 2, t->y2, t->x2 + t->w2 / 2, t->y2, true))
+BENCH_CHECK(bench_polys, sc2d_check_polys(t->x1, t->y1, &t->poly1, t->x2, t->y2, &t->poly2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_polys_cached, sc2d_check_polys_cached(t->x1, t->y1, &t->poly1, t->x2, t->y2, &t->poly2, &t->cache, &overlap_x, &overlap_y))
+BENCH_TEST(bench_point_poly, sc2d_check_point_poly(t->x1, t->y1, t->x2, t->y2, &t->poly2))
+BENCH_CHECK(bench_circle_poly, sc2d_check_circle_poly(t->x1, t->y1, t->r1, t->x2, t->y2, &t->poly2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_poly2d_strided, sc2d_check_poly2d_strided(t->x1, t->y1, &t->view1, t->x2, t->y2, &t->view2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circle_poly2d_strided, sc2d_check_circle_poly2d_strided(t->x1, t->y1, t->r1, t->x2, t->y2, &t->view2, &overlap_x, &overlap_y))
+BENCH_TEST(bench_point_poly2d_strided, sc2d_check_point_poly2d_strided(t->x1 - t->x2, t->y1 - t->y2, &t->view2))
+BENCH_CHECK(bench_poly2d_bounded, sc2d_check_poly2d_bounded(t->x1, t->y1, t->verts1, t->count1, t->radius1, t->x2, t->y2, t->verts2, t->count2, t->radius2, &overlap_x, &overlap_y))
+BENCH_TEST(bench_point_poly2d_bounded, sc2d_check_point_poly2d_bounded(t->x1 - t->x2, t->y1 - t->y2, t->verts2, t->count2, t->radius2))
+BENCH_CHECK(bench_poly2d_transformed, sc2d_check_poly2d_transformed(t->verts1, t->count1, &t->transform1, t->verts2, t->count2, &t->transform2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_polys_transformed, sc2d_check_polys_transformed(&t->poly1, &t->transform1, &t->poly2, &t->transform2, &overlap_x, &overlap_y))
+BENCH_CHECK(bench_circle_poly2d_transformed, sc2d_check_circle_poly2d_transformed(t->x1, t->y1, t->r1, t->verts2, t->count2, &t->transform2, &overlap_x, &overlap_y))
+BENCH_TEST(bench_manifold_poly2d, sc2d_manifold_poly2d(t->x1, t->y1, t->verts1, t->count1, t->x2, t->y2, t->verts2, t->count2, &t->manifold))
+BENCH_TEST(bench_manifold_polys, sc2d_manifold_polys(t->x1, t->y1, &t->poly1, t->x2, t->y2, &t->poly2, &t->manifold))
+BENCH_TEST(bench_manifold_circle_poly2d, sc2d_manifold_circle_poly2d(t->x1, t->y1, t->r1, t->x2, t->y2, t->verts2, t->count2, &t->manifold))
+BENCH_TEST(bench_gjk, sc2d_check_gjk(&t->shape1, &t->shape2))
+BENCH_CHECK(bench_shapes, sc2d_check_shapes(&t->shape1, &t->shape2, &overlap_x, &overlap_y))
+
+BENCH_CHECK(bench_collide, sc2d_collide(&t->any1, &t->any2, &overlap_x, &overlap_y))
+
+// Batch functions run a whole sample per call, so their numbers are per pair as well
+
+static int bench_circles_batch(int first, int count) {
+	static sc2d_hit hits[TEST_COUNT];
+	return sc2d_check_circles_batch(mix->circle_x, mix->circle_y, mix->circle_r, mix->pairs + first, count, hits);
+}
+
+static int bench_rects_batch(int first, int count) {
+	static unsigned char hit_mask[TEST_COUNT];
+	static float overlap_x[TEST_COUNT], overlap_y[TEST_COUNT];
+	return sc2d_check_rects_batch(mix->rect_x, mix->rect_y, mix->rect_w, mix->rect_h, mix->pairs + first, count, hit_mask, overlap_x, overlap_y);
+}
+
+static int bench_circle_many(int first, int count) {
+	static sc2d_hit hits[TEST_COUNT];
+	return sc2d_check_circle_many(0, 0, MANY_RADIUS, mix->many_x + first, mix->many_y + first, mix->many_r + first, count, hits);
+}
+
+static int bench_collide_pairs(int first, int count) {
+	static sc2d_hit hits[TEST_COUNT];
+	return sc2d_collide_pairs(mix->shapes, mix->pairs + first, count, hits);
+}
+
+typedef struct Bench {
+	const char* name;
+	int (*run)(int first, int count);
+} Bench;
+
+static const Bench benches[] = {
+	{"sc2d_check_point_circle", bench_point_circle},
+	{"sc2d_check_point_rect", bench_point_rect},
+	{"sc2d_check_circles", bench_circles},
+	{"sc2d_check_rects", bench_rects},
+	{"sc2d_check_circle_centered_rect", bench_circle_centered_rect},
+	{"sc2d_check_circle_rect", bench_circle_rect},
+	{"sc2d_check_poly2d", bench_poly2d},
+	{"sc2d_check_poly2d_cached", bench_poly2d_cached},
+	{"sc2d_check_circle_poly2d", bench_circle_poly2d},
+	{"sc2d_check_point_poly2d", bench_point_poly2d},
+	{"sc2d_check_point_line", bench_point_line},
+	{"sc2d_check_polys", bench_polys},
+	{"sc2d_check_polys_cached", bench_polys_cached},
+	{"sc2d_check_point_poly", bench_point_poly},
+	{"sc2d_check_circle_poly", bench_circle_poly},
+	{"sc2d_check_poly2d_strided", bench_poly2d_strided},
+	{"sc2d_check_circle_poly2d_strided", bench_circle_poly2d_strided},
+	{"sc2d_check_point_poly2d_strided", bench_point_poly2d_strided},
+	{"sc2d_check_poly2d_bounded", bench_poly2d_bounded},
+	{"sc2d_check_point_poly2d_bounded", bench_point_poly2d_bounded},
+	{"sc2d_check_poly2d_transformed", bench_poly2d_transformed},
+	{"sc2d_check_polys_transformed", bench_polys_transformed},
+	{"sc2d_check_circle_poly2d_transformed", bench_circle_poly2d_transformed},
+	{"sc2d_manifold_poly2d", bench_manifold_poly2d},
+	{"sc2d_manifold_polys", bench_manifold_polys},
+	{"sc2d_manifold_circle_poly2d", bench_manifold_circle_poly2d},
+	{"sc2d_check_gjk", bench_gjk},
+	{"sc2d_check_shapes", bench_shapes},
+	{"sc2d_collide", bench_collide},
+	{"sc2d_check_circles_batch", bench_circles_batch},
+	{"sc2d_check_rects_batch", bench_rects_batch},
+	{"sc2d_check_circle_many", bench_circle_many},
+	{"sc2d_collide_pairs", bench_collide_pairs},
+};
+
+#define BENCH_COUNT (int)(sizeof(benches) / sizeof(benches[0]))
+
+// Scene generation
+
+// Smallest distance from the center to the boundary (inner) and largest (outer) of every shape a test side can be
+static void random_side(float* r, float* w, float* h, float* verts, int* count, float* inner, float* outer) {
+	static const int sides[] = {3, 4, 5, 6, 8, 12, 32};
+	float poly_radius = random_float(6, 16);
+
+	*r = random_float(4, 16);
+	*w = random_float(8, 32);
+	*h = random_float(8, 32);
+	*count = sides[(int)random_float(0, 6.999f)];
+	generate_polygon(verts, *count, poly_radius, random_float(0, 6.2831853f));
+
+	float poly_inner = poly_radius * cosf(3.14159265f / *count);
+	*inner = sc2d_min(sc2d_min(*r, sc2d_min(*w, *h) / 2), poly_inner);
+	*outer = sc2d_max(sc2d_max(*r, sc2d_hypotf(*w, *h) / 2), poly_radius);
+}
+
+// Circle, rect (top left corner) or polygon with the sizes of one test side
+static sc2d_shape random_shape(float x, float y, float r, float w, float h, float* verts, int count) {
+	sc2d_shape shape = {SC2D_SHAPE_CIRCLE, x, y, 0, 0, r, 0, 0, false};
+	int type = (int)random_float(0, 2.999f);
+
+	if (type == 1) {
+		shape = (sc2d_shape){SC2D_SHAPE_RECT, x - w / 2, y - h / 2, w, h, 0, 0, 0, false};
+	} else if (type == 2) {
+		shape = (sc2d_shape){SC2D_SHAPE_POLY, x, y, 0, 0, 0, verts, count, false};
+	}
+	return shape;
+}
+
+// Tests placed to overlap are closer than the sum of the inner sizes, the rest farther than the sum of the outer sizes,
+// so the hit share is the same for every function.
+static void generate_mix(Mix* m, const char* name, float hit_share) {
+	m->name = name;
+	m->hit_share = hit_share;
+
+	for (int i = 0; i < TEST_COUNT; i++) {
+		Test* t = m->tests + i;
+		float inner1, outer1, inner2, outer2;
+
+		random_side(&t->r1, &t->w1, &t->h1, t->verts1, &t->count1, &inner1, &outer1);
+		random_side(&t->r2, &t->w2, &t->h2, t->verts2, &t->count2, &inner2, &outer2);
+
+		bool hit = random_float(0, 1) < hit_share;
+		float distance = hit ? random_float(0, 0.9f * (inner1 + inner2)) : random_float(1.05f, 3.0f) * (outer1 + outer2);
+		float angle = random_float(0, 6.2831853f);
+
+		t->x1 = random_float(-1000, 1000);
+		t->y1 = random_float(-1000, 1000);
+		t->x2 = t->x1 + cosf(angle) * distance;
+		t->y2 = t->y1 + sinf(angle) * distance;
+
+		sc2d_poly_init(&t->poly1, t->verts1, t->count1, t->storage1);
+		sc2d_poly_init(&t->poly2, t->verts2, t->count2, t->storage2);
+		memset(&t->cache, 0, sizeof(t->cache));
+		t->radius1 = sc2d_poly2d_radius(t->verts1, t->count1);
+		t->radius2 = sc2d_poly2d_radius(t->verts2, t->count2);
+
+		t->shape1 = (sc2d_shape){SC2D_SHAPE_POLY, t->x1, t->y1, 0, 0, 0, t->verts1, t->count1, false};
+		t->shape2 = (sc2d_shape){SC2D_SHAPE_POLY, t->x2, t->y2, 0, 0, 0, t->verts2, t->count2, false};
+
+		// Regular polygons keep their inner and outer radius under rotation, so the mix stays the same
+		float angle1 = random_float(0, 6.2831853f), angle2 = random_float(0, 6.2831853f);
+		t->transform1 = (sc2d_transform){t->x1, t->y1, cosf(angle1), sinf(angle1), 1.0f};
+		t->transform2 = (sc2d_transform){t->x2, t->y2, cosf(angle2), sinf(angle2), 1.0f};
+
+		t->view1 = (sc2d_verts){t->verts1, 2 * sizeof(float), 0, sizeof(float), t->count1};
+		t->view2 = (sc2d_verts){t->verts2, 2 * sizeof(float), 0, sizeof(float), t->count2};
+
+		t->any1 = random_shape(t->x1, t->y1, t->r1, t->w1, t->h1, t->verts1, t->count1);
+		t->any2 = random_shape(t->x2, t->y2, t->r2, t->w2, t->h2, t->verts2, t->count2);
+
+		m->circle_x[i * 2] = t->x1;				m->circle_x[i * 2 + 1] = t->x2;
+		m->circle_y[i * 2] = t->y1;				m->circle_y[i * 2 + 1] = t->y2;
+		m->circle_r[i * 2] = t->r1;				m->circle_r[i * 2 + 1] = t->r2;
+		m->rect_x[i * 2] = t->x1 - t->w1 / 2;	m->rect_x[i * 2 + 1] = t->x2 - t->w2 / 2;
+		m->rect_y[i * 2] = t->y1 - t->h1 / 2;	m->rect_y[i * 2 + 1] = t->y2 - t->h2 / 2;
+		m->rect_w[i * 2] = t->w1;				m->rect_w[i * 2 + 1] = t->w2;
+		m->rect_h[i * 2] = t->h1;				m->rect_h[i * 2 + 1] = t->h2;
+		m->shapes[i * 2] = t->any1;				m->shapes[i * 2 + 1] = t->any2;
+		m->pairs[i].a = i * 2;
+		m->pairs[i].b = i * 2 + 1;
+
+		float many_distance = hit ? random_float(0, 0.9f * (MANY_RADIUS + t->r2)) : random_float(1.05f, 3.0f) * (MANY_RADIUS + t->r2);
+		m->many_x[i] = cosf(angle) * many_distance;
+		m->many_y[i] = sinf(angle) * many_distance;
+		m->many_r[i] = t->r2;
+	}
+}
+
+// Timing
+
+static double samples[MAX_SAMPLES];
+
+static int compare_doubles(const void* a, const void* b) {
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static double percentile(double* sorted, int count, double p) {
+	int index = (int)(p * (count - 1) + 0.5);
+	return sorted[index];
+}
+
+static Result run_bench(const Bench* bench, Mix* m, double seconds) {
+	Result result = {bench->name, m->name, 0, 0, 0, 0, 0, 0};
+	long long tests = 0, hits = 0;
+	int sample_count = 0, first = 0;
+	double total = 0;
+
+	mix = m;
+	bench->run(0, TEST_COUNT); // Warm up caches and branch predictors
+
+	while ((total < seconds || sample_count < 16) && sample_count < MAX_SAMPLES) {
+		double start = now_seconds();
+		hits += bench->run(first, SAMPLE_SIZE);
+		double elapsed = now_seconds() - start;
+
+		samples[sample_count++] = elapsed * 1e9 / SAMPLE_SIZE;
+		total += elapsed;
+		tests += SAMPLE_SIZE;
+		first = (first + SAMPLE_SIZE) % TEST_COUNT;
+	}
+
+	qsort(samples, sample_count, sizeof(double), compare_doubles);
+
+	result.ns_per_test = total * 1e9 / (double)tests;
+	result.tests_per_sec = (double)tests / total;
+	result.p50 = percentile(samples, sample_count, 0.50);
+	result.p90 = percentile(samples, sample_count, 0.90);
+	result.p99 = percentile(samples, sample_count, 0.99);
+	result.hit_rate = (double)hits / (double)tests;
+
+	return result;
+}
+
+static void write_json(FILE* file, unsigned int seed, double seconds, Result* results, int count) {
+	fprintf(file, "{\n\t\"seed\": %u,\n\t\"seconds_per_run\": %g,\n\t\"sample_size\": %d,\n\t\"results\": [\n", seed, seconds, SAMPLE_SIZE);
+
+	for (int i = 0; i < count; i++) {
+		Result* r = results + i;
+		fprintf(file, "\t\t{\"function\": \"%s\", \"mix\": \"%s\", \"ns_per_test\": %.3f, \"tests_per_sec\": %.0f, "
+					  "\"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"hit_rate\": %.3f}%s\n",
+				r->function, r->mix, r->ns_per_test, r->tests_per_sec, r->p50, r->p90, r->p99, r->hit_rate,
+				(i + 1 < count) ? "," : "");
+	}
+
+	fprintf(file, "\t]\n}\n");
+}
+
+int main(int argc, char** argv) {
+	static Result results[BENCH_COUNT * 2];
+	unsigned int seed = 1;
+	double seconds = 0.1;
+	const char* filter = 0;
+	const char* json_path = 0;
+	int result_count = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--seed") && i + 1 < argc) seed = (unsigned int)strtoul(argv[++i], 0, 10);
+		else if (!strcmp(argv[i], "--time") && i + 1 < argc) seconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+		else if (!strcmp(argv[i], "--json") && i + 1 < argc) json_path = argv[++i];
+		else {
+			fprintf(stderr, "Usage: %s [--seed N] [--time SECONDS] [--filter TEXT] [--json FILE]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	random_seed(seed);
+	generate_mix(&mixes[0], "hit", HIT_HEAVY_SHARE);
+	generate_mix(&mixes[1], "miss", MISS_HEAVY_SHARE);
+
+	printf("%-37s %-5s %10s %14s %9s %9s %9s %6s\n", "function", "mix", "ns/test", "tests/sec", "p50", "p90", "p99", "hits");
+
+	for (int b = 0; b < BENCH_COUNT; b++) {
+		if (filter && !strstr(benches[b].name, filter)) continue;
+
+		for (int m = 0; m < 2; m++) {
+			Result r = run_bench(benches + b, mixes + m, seconds);
+			results[result_count++] = r;
+
+			printf("%-37s %-5s %10.2f %14.0f %9.2f %9.2f %9.2f %5.0f%%\n",
+				   r.function, r.mix, r.ns_per_test, r.tests_per_sec, r.p50, r.p90, r.p99, r.hit_rate * 100.0);
+		}
+	}
+
+	if (json_path) {
+		FILE* file = fopen(json_path, "w");
+		if (!file) {
+			fprintf(stderr, "Could not open %s\n", json_path);
+			return 1;
+		}
+		write_json(file, seed, seconds, results, result_count);
+		fclose(file);
+	}
+
+	return 0;
+}
@@ -0,0 +1,158 @@
+// Miss path cost of the circle checks: the previous sc2d_hypotf-first versions against the squared distance
+// versions and the boolean-only sc2d_test_* functions. Headless, no raylib required.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define SIMPLE_COLLISION_2D_IMPLEMENTATION 1
+#include "../sc2d.h"
+
+#include "bench_common.h"
+
+#define TEST_COUNT 4096
+#define MIN_SECONDS 0.25
+
+typedef struct Test {
+	float x1, y1, r1, x2, y2, r2, w, h;
+} Test;
+
+// Previous implementations, which take the square root before deciding
+// Not static, so the compiler inlines them no more eagerly than the library functions
+
+bool previous_check_point_circle(float px, float py, float cx, float cy, float cr, float* overlap_x, float* overlap_y) {
+	float delta_x = cx - px;
+	float delta_y = cy - py;
+	float delta_m = sc2d_hypotf(delta_x, delta_y);
+	float delta_r = cr - delta_m;
+	bool result;
+
+	if ((result = delta_r > 0)) {
+		*overlap_x = (delta_x / delta_m) * delta_r;
+		*overlap_y = (delta_y / delta_m) * delta_r;
+	}
+	return result;
+}
+
+bool previous_check_circles(float p1x, float p1y, float r1, float p2x, float p2y, float r2, float* overlap_x, float* overlap_y) {
+	float delta_x = p2x - p1x;
+	float delta_y = p2y - p1y;
+	float magnitude = sc2d_hypotf(delta_x, delta_y);
+	float overlap_magnitude = (r1 + r2) - magnitude;
+	bool result;
+
+	if ((result = overlap_magnitude > 0)) {
+		*overlap_x = (delta_x / magnitude) * overlap_magnitude;
+		*overlap_y = (delta_y / magnitude) * overlap_magnitude;
+	}
+	return result;
+}
+
+bool previous_check_circle_centered_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y) {
+	float delta_x = cx - rx;
+	float delta_y = cy - ry;
+
+	if (sc2d_fabsf(delta_x) > (cr + rw) || sc2d_fabsf(delta_y) > (cr + rh)) return false;
+
+	float clamp_x = sc2d_min(sc2d_max(delta_x, -rw), rw) - delta_x;
+	float clamp_y = sc2d_min(sc2d_max(delta_y, -rh), rh) - delta_y;
+	float magnitude = sc2d_hypotf(clamp_x, clamp_y);
+
+	if (magnitude == 0.0f) magnitude = 1.0f;
+	if (magnitude < cr) {
+		*overlap_x = (clamp_x / magnitude) * (cr - magnitude);
+		*overlap_y = (clamp_y / magnitude) * (cr - magnitude);
+		return true;
+	}
+	return false;
+}
+
+enum { FUNCTION_POINT_CIRCLE, FUNCTION_CIRCLES, FUNCTION_CIRCLE_RECT, FUNCTION_COUNT };
+enum { VERSION_PREVIOUS, VERSION_CHECK, VERSION_TEST, VERSION_COUNT };
+
+static const char* function_names[FUNCTION_COUNT] = {"point_circle", "circles", "circle_centered_rect"};
+static const char* version_names[VERSION_COUNT] = {"previous", "check", "test"};
+
+static int run_pass(int function, int version, Test* tests, float* sink) {
+	int hits = 0;
+
+	for (int i = 0; i < TEST_COUNT; i++) {
+		Test* t = tests + i;
+		float overlap_x = 0, overlap_y = 0;
+		bool hit = false;
+
+		switch (function * VERSION_COUNT + version) {
+			case FUNCTION_POINT_CIRCLE * VERSION_COUNT + VERSION_PREVIOUS: hit = previous_check_point_circle(t->x1, t->y1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y); break;
+			case FUNCTION_POINT_CIRCLE * VERSION_COUNT + VERSION_CHECK:    hit = sc2d_check_point_circle(t->x1, t->y1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y); break;
+			case FUNCTION_POINT_CIRCLE * VERSION_COUNT + VERSION_TEST:     hit = sc2d_test_point_circle(t->x1, t->y1, t->x2, t->y2, t->r2); break;
+
+			case FUNCTION_CIRCLES * VERSION_COUNT + VERSION_PREVIOUS: hit = previous_check_circles(t->x1, t->y1, t->r1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y); break;
+			case FUNCTION_CIRCLES * VERSION_COUNT + VERSION_CHECK:    hit = sc2d_check_circles(t->x1, t->y1, t->r1, t->x2, t->y2, t->r2, &overlap_x, &overlap_y); break;
+			case FUNCTION_CIRCLES * VERSION_COUNT + VERSION_TEST:     hit = sc2d_test_circles(t->x1, t->y1, t->r1, t->x2, t->y2, t->r2); break;
+
+			case FUNCTION_CIRCLE_RECT * VERSION_COUNT + VERSION_PREVIOUS: hit = previous_check_circle_centered_rect(t->x1, t->y1, t->r1, t->x2, t->y2, t->w, t->h, &overlap_x, &overlap_y); break;
+			case FUNCTION_CIRCLE_RECT * VERSION_COUNT + VERSION_CHECK:    hit = sc2d_check_circle_centered_rect(t->x1, t->y1, t->r1, t->x2, t->y2, t->w, t->h, &overlap_x, &overlap_y); break;
+			case FUNCTION_CIRCLE_RECT * VERSION_COUNT + VERSION_TEST:     hit = sc2d_test_circle_centered_rect(t->x1, t->y1, t->r1, t->x2, t->y2, t->w, t->h); break;
+		}
+
+		hits += hit;
+		*sink += overlap_x + overlap_y;
+	}
+
+	return hits;
+}
+
+// Returns nanoseconds per test
+static double run(int function, int version, Test* tests, int* hits) {
+	float sink = 0;
+	long long count = 0;
+	double start = now_seconds(), elapsed = 0;
+
+	do {
+		*hits = run_pass(function, version, tests, &sink);
+		count += TEST_COUNT;
+		elapsed = now_seconds() - start;
+	} while (elapsed < MIN_SECONDS);
+
+	if (sink == 12345.0f) printf(" "); // Keep the overlaps alive
+	return elapsed * 1e9 / (double)count;
+}
+
+// Shapes with radii and half sizes of 1-8 units in a square of the given size: small squares give mostly hits
+static void generate_tests(Test* tests, float spread) {
+	for (int i = 0; i < TEST_COUNT; i++) {
+		tests[i].x1 = random_float(0, spread);
+		tests[i].y1 = random_float(0, spread);
+		tests[i].r1 = random_float(1, 8);
+		tests[i].x2 = random_float(0, spread);
+		tests[i].y2 = random_float(0, spread);
+		tests[i].r2 = random_float(1, 8);
+		tests[i].w = random_float(1, 8);
+		tests[i].h = random_float(1, 8);
+	}
+}
+
+int main(void) {
+	static Test miss_tests[TEST_COUNT], hit_tests[TEST_COUNT];
+
+	generate_tests(miss_tests, 400.0f); // Mostly misses, like a broadphase candidate list
+	generate_tests(hit_tests, 12.0f);	// Mostly hits
+
+	printf("%-22s %-6s %-10s %10s %8s\n", "function", "mix", "version", "ns/test", "hits");
+
+	for (int function = 0; function < FUNCTION_COUNT; function++) {
+		for (int mix = 0; mix < 2; mix++) {
+			Test* tests = mix ? hit_tests : miss_tests;
+
+			for (int version = 0; version < VERSION_COUNT; version++) {
+				int hits;
+				double ns = run(function, version, tests, &hits);
+				printf("%-22s %-6s %-10s %10.2f %8d\n", function_names[function], mix ? "hit" : "miss", version_names[version], ns, hits);
+			}
+		}
+	}
+
+	return 0;
+}
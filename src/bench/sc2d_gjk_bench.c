@@ -0,0 +1,111 @@
+// Compares SAT (sc2d_check_poly2d) with GJK (sc2d_check_gjk) and GJK + EPA (sc2d_check_shapes)
+// on regular polygons with 4, 8, 32 and 128 vertices. Headless, no raylib required.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define SIMPLE_COLLISION_2D_IMPLEMENTATION 1
+#include "../sc2d.h"
+
+#include "bench_common.h"
+
+#define PAIR_COUNT 1024
+#define MIN_SECONDS 0.25
+#define POLYGON_RADIUS 20.0f
+
+typedef struct Pair {
+	float x1, y1, x2, y2;
+} Pair;
+
+// Center distances up to max_distance, in units of the polygon radius
+static void generate_pairs(Pair* pairs, float min_distance, float max_distance) {
+	for (int i = 0; i < PAIR_COUNT; i++) {
+		float angle = random_float(0, 6.2831853f);
+		float distance = random_float(min_distance, max_distance) * POLYGON_RADIUS;
+
+		pairs[i].x1 = random_float(-100, 100);
+		pairs[i].y1 = random_float(-100, 100);
+		pairs[i].x2 = pairs[i].x1 + cosf(angle) * distance;
+		pairs[i].y2 = pairs[i].y1 + sinf(angle) * distance;
+	}
+}
+
+enum { METHOD_SAT, METHOD_GJK, METHOD_GJK_EPA, METHOD_COUNT };
+static const char* method_names[METHOD_COUNT] = {"sat", "gjk", "gjk+epa"};
+
+// Returns nanoseconds per test, and the number of hits in one pass over the pairs
+static double run(int method, Pair* pairs, float* v1, float* v2, int count, int* hits) {
+	sc2d_shape s1 = {SC2D_SHAPE_POLY, 0, 0, 0, 0, 0, v1, count, false};
+	sc2d_shape s2 = {SC2D_SHAPE_POLY, 0, 0, 0, 0, 0, v2, count, false};
+	volatile float sink = 0;
+	long long tests = 0;
+	double start = now_seconds(), elapsed = 0;
+
+	*hits = 0;
+	do {
+		int pass_hits = 0;
+
+		for (int i = 0; i < PAIR_COUNT; i++) {
+			float overlap_x = 0, overlap_y = 0;
+			bool hit = false;
+
+			switch (method) {
+				case METHOD_SAT:
+					hit = sc2d_check_poly2d(pairs[i].x1, pairs[i].y1, v1, count, pairs[i].x2, pairs[i].y2, v2, count, &overlap_x, &overlap_y);
+					break;
+				case METHOD_GJK:
+					s1.x = pairs[i].x1; s1.y = pairs[i].y1;
+					s2.x = pairs[i].x2; s2.y = pairs[i].y2;
+					hit = sc2d_check_gjk(&s1, &s2);
+					break;
+				case METHOD_GJK_EPA:
+					s1.x = pairs[i].x1; s1.y = pairs[i].y1;
+					s2.x = pairs[i].x2; s2.y = pairs[i].y2;
+					hit = sc2d_check_shapes(&s1, &s2, &overlap_x, &overlap_y);
+					break;
+			}
+
+			pass_hits += hit;
+			sink += overlap_x;
+		}
+
+		*hits = pass_hits;
+		tests += PAIR_COUNT;
+		elapsed = now_seconds() - start;
+	} while (elapsed < MIN_SECONDS);
+
+	(void)sink;
+	return elapsed * 1e9 / (double)tests;
+}
+
+int main(void) {
+	static const int vert_counts[] = {4, 8, 32, 128};
+	static float v1[128 * 2], v2[128 * 2];
+	static Pair hit_pairs[PAIR_COUNT], miss_pairs[PAIR_COUNT];
+
+	generate_pairs(hit_pairs, 0.0f, 1.6f);
+	generate_pairs(miss_pairs, 2.1f, 4.0f);
+
+	printf("%-6s %-8s %-10s %10s %8s\n", "verts", "mix", "method", "ns/test", "hits");
+
+	for (int v = 0; v < (int)(sizeof(vert_counts) / sizeof(vert_counts[0])); v++) {
+		int count = vert_counts[v];
+		generate_polygon(v1, count, POLYGON_RADIUS, 0.0f);
+		generate_polygon(v2, count, POLYGON_RADIUS, 0.3f);
+
+		for (int mix = 0; mix < 2; mix++) {
+			Pair* pairs = mix ? miss_pairs : hit_pairs;
+
+			for (int method = 0; method < METHOD_COUNT; method++) {
+				int hits;
+				double ns = run(method, pairs, v1, v2, count, &hits);
+				printf("%-6d %-8s %-10s %10.1f %8d\n", count, mix ? "miss" : "hit", method_names[method], ns, hits);
+			}
+		}
+	}
+
+	return 0;
+}
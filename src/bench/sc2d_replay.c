@@ -0,0 +1,334 @@
+// Replay of a trace recorded with SIMPLE_COLLISION_2D_TRACE (see sc2d_trace_start) against the current build
+// Re-runs every recorded call, reports the calls whose result differs from the recording, then times each function
+// on its recorded calls. Exits with 1 if any result differs, so it can guard against regressions.
+//
+// Usage: sc2d_replay TRACE [--time SECONDS]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define SIMPLE_COLLISION_2D_IMPLEMENTATION 1
+#include "../sc2d.h"
+
+#include "bench_common.h"
+
+#define MAX_REPORTED 10				// Differences printed in full
+
+// One recorded call, pointing into the mapped trace
+typedef struct Call {
+	int function;
+	int flags;
+	float* args;
+	float* overlap;					// Recorded overlap, or NULL
+	int poly_count;
+	float* verts[2];
+	int counts[2];
+	sc2d_poly polys[2];				// Built from the vertices for the sc2d_poly checks
+} Call;
+
+// Read-only view of a whole file
+typedef struct Mapping {
+	void* data;
+	size_t size;
+#ifdef _WIN32
+	HANDLE file, mapping;
+#endif
+} Mapping;
+
+static bool map_file(const char* path, Mapping* map) {
+#ifdef _WIN32
+	LARGE_INTEGER size;
+
+	map->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (map->file == INVALID_HANDLE_VALUE) return false;
+	if (!GetFileSizeEx(map->file, &size) || size.QuadPart == 0) {
+		CloseHandle(map->file);
+		return false;
+	}
+
+	map->size = (size_t)size.QuadPart;
+	map->mapping = CreateFileMappingA(map->file, 0, PAGE_READONLY, 0, 0, 0);
+	map->data = map->mapping ? MapViewOfFile(map->mapping, FILE_MAP_READ, 0, 0, 0) : 0;
+	if (!map->data) {
+		if (map->mapping) CloseHandle(map->mapping);
+		CloseHandle(map->file);
+		return false;
+	}
+	return true;
+#else
+	struct stat info;
+	int file = open(path, O_RDONLY);
+
+	if (file < 0) return false;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	map->size = (size_t)info.st_size;
+	map->data = mmap(0, map->size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // The mapping keeps the file open
+	return map->data != MAP_FAILED;
+#endif
+}
+
+static void unmap_file(Mapping* map) {
+#ifdef _WIN32
+	UnmapViewOfFile(map->data);
+	CloseHandle(map->mapping);
+	CloseHandle(map->file);
+#else
+	munmap(map->data, map->size);
+#endif
+}
+
+// Number of float arguments each replayed function was recorded with, 0 for functions that are never recorded
+static int expected_args(int function) {
+	switch (function) {
+		case SC2D_STAT_POINT_CIRCLE: case SC2D_STAT_TEST_POINT_CIRCLE: return 5;
+		case SC2D_STAT_POINT_RECT: case SC2D_STAT_CIRCLES: case SC2D_STAT_TEST_CIRCLES: return 6;
+		case SC2D_STAT_CIRCLE_CENTERED_RECT: case SC2D_STAT_CIRCLE_RECT: case SC2D_STAT_POINT_LINE: return 7;
+		case SC2D_STAT_TEST_CIRCLE_CENTERED_RECT: case SC2D_STAT_TEST_CIRCLE_RECT: return 7;
+		case SC2D_STAT_RECTS: return 8;
+		case SC2D_STAT_POLY2D: case SC2D_STAT_POLYS: case SC2D_STAT_POINT_POLY: return 4;
+		case SC2D_STAT_POINT_POLY2D: return 2;
+		case SC2D_STAT_CIRCLE_POLY2D: case SC2D_STAT_TEST_CIRCLE_POLY2D: return 5;
+		case SC2D_STAT_CIRCLE_POLY: case SC2D_STAT_TEST_CIRCLE_POLY: return 5;
+		default: return 0;
+	}
+}
+
+// Check every record against the layout of its function, and point the calls into the trace
+// A record cut off by the end of the file (a recording that didn't stop) ends the trace, and its bytes are added to truncated.
+// Returns the number of calls, or -1 if the trace is malformed.
+static int parse_trace(char* data, size_t size, Call* calls, size_t* truncated) {
+	size_t offset = sizeof(sc2d_trace_header);
+	int count = 0;
+
+	while (offset < size) {
+		sc2d_trace_record* record = (sc2d_trace_record*)(data + offset);
+		if (size - offset < sizeof(sc2d_trace_record) || (size_t)record->size > size - offset) {
+			*truncated = size - offset;
+			break;
+		}
+		if (record->size < (int)sizeof(sc2d_trace_record) || record->size % 4 != 0) return -1;
+
+		int function = record->function;
+		int value_count = record->arg_count + ((record->flags & SC2D_TRACE_OVERLAP) ? 2 : 0);
+		char* end = data + offset + record->size;
+		char* cursor = (char*)(record + 1) + value_count * sizeof(float);
+
+		if (function >= SC2D_STAT_FUNCTION_COUNT || record->arg_count != expected_args(function) || record->poly_count > 2) return -1;
+		if (cursor > end) return -1;
+
+		if (calls) {
+			Call* call = calls + count;
+			call->function = function;
+			call->flags = record->flags;
+			call->args = (float*)(record + 1);
+			call->overlap = (record->flags & SC2D_TRACE_OVERLAP) ? call->args + record->arg_count : 0;
+			call->poly_count = record->poly_count;
+		}
+
+		for (int i = 0; i < record->poly_count; i++) {
+			sc2d_trace_poly* poly = (sc2d_trace_poly*)cursor;
+			if (end - cursor < (ptrdiff_t)sizeof(sc2d_trace_poly) || poly->count < 1 ||
+				(end - cursor - (ptrdiff_t)sizeof(sc2d_trace_poly)) / (ptrdiff_t)(2 * sizeof(float)) < poly->count) return -1;
+
+			if (calls) {
+				calls[count].verts[i] = (float*)(poly + 1);
+				calls[count].counts[i] = poly->count;
+				calls[count].polys[i].hull = poly->hull;
+			}
+			cursor += sizeof(sc2d_trace_poly) + poly->count * 2 * sizeof(float);
+		}
+
+		offset += (size_t)record->size;
+		count++;
+	}
+
+	return count;
+}
+
+// Run one call against the current build, with the same arguments as when it was recorded
+static bool replay(Call* call, float* overlap_x, float* overlap_y) {
+	float* a = call->args;
+
+	switch (call->function) {
+		case SC2D_STAT_POINT_CIRCLE: return sc2d_check_point_circle(a[0], a[1], a[2], a[3], a[4], overlap_x, overlap_y);
+		case SC2D_STAT_POINT_RECT: return sc2d_check_point_rect(a[0], a[1], a[2], a[3], a[4], a[5], overlap_x, overlap_y);
+		case SC2D_STAT_CIRCLES: return sc2d_check_circles(a[0], a[1], a[2], a[3], a[4], a[5], overlap_x, overlap_y);
+		case SC2D_STAT_RECTS: return sc2d_check_rects(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7], overlap_x, overlap_y);
+		case SC2D_STAT_CIRCLE_CENTERED_RECT: return sc2d_check_circle_centered_rect(a[0], a[1], a[2], a[3], a[4], a[5], a[6], overlap_x, overlap_y);
+		case SC2D_STAT_CIRCLE_RECT: return sc2d_check_circle_rect(a[0], a[1], a[2], a[3], a[4], a[5], a[6], overlap_x, overlap_y);
+		case SC2D_STAT_TEST_POINT_CIRCLE: return sc2d_test_point_circle(a[0], a[1], a[2], a[3], a[4]);
+		case SC2D_STAT_TEST_CIRCLES: return sc2d_test_circles(a[0], a[1], a[2], a[3], a[4], a[5]);
+		case SC2D_STAT_TEST_CIRCLE_CENTERED_RECT: return sc2d_test_circle_centered_rect(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+		case SC2D_STAT_TEST_CIRCLE_RECT: return sc2d_test_circle_rect(a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+		case SC2D_STAT_POINT_LINE: return sc2d_check_point_line(a[0], a[1], a[2], a[3], a[4], a[5], a[6] != 0);
+
+		// Vertices are recorded as x/y pairs, the layout sc2d_check_poly2d reads in this build
+		case SC2D_STAT_POLY2D:
+			return sc2d_check_poly2d(a[0], a[1], call->verts[0], call->counts[0], a[2], a[3], call->verts[1], call->counts[1], overlap_x, overlap_y);
+		case SC2D_STAT_CIRCLE_POLY2D: return sc2d_check_circle_poly2d(a[0], a[1], a[2], a[3], a[4], call->verts[0], call->counts[0], overlap_x, overlap_y);
+		case SC2D_STAT_POINT_POLY2D: return sc2d_check_point_poly2d(a[0], a[1], call->verts[0], call->counts[0]);
+		case SC2D_STAT_TEST_CIRCLE_POLY2D: return sc2d_test_circle_poly2d(a[0], a[1], a[2], a[3], a[4], call->verts[0], call->counts[0]);
+
+		case SC2D_STAT_POLYS: return sc2d_check_polys(a[0], a[1], call->polys, a[2], a[3], call->polys + 1, overlap_x, overlap_y);
+		case SC2D_STAT_POINT_POLY: return sc2d_check_point_poly(a[0], a[1], a[2], a[3], call->polys);
+		case SC2D_STAT_CIRCLE_POLY: return sc2d_check_circle_poly(a[0], a[1], a[2], a[3], a[4], call->polys, overlap_x, overlap_y);
+		case SC2D_STAT_TEST_CIRCLE_POLY: return sc2d_test_circle_poly(a[0], a[1], a[2], a[3], a[4], call->polys);
+		default: return false;
+	}
+}
+
+static bool uses_polys(int function) {
+	return function == SC2D_STAT_POLYS || function == SC2D_STAT_POINT_POLY || function == SC2D_STAT_CIRCLE_POLY || function == SC2D_STAT_TEST_CIRCLE_POLY;
+}
+
+// Same result as recorded: hit or miss, and the exact overlap of a hit
+static bool same_result(Call* call, bool hit, float overlap_x, float overlap_y) {
+	if (hit != ((call->flags & SC2D_TRACE_HIT) != 0)) return false;
+	if (!hit || !call->overlap) return true;
+	return memcmp(&overlap_x, call->overlap, sizeof(float)) == 0 && memcmp(&overlap_y, call->overlap + 1, sizeof(float)) == 0;
+}
+
+static void print_call(int index, Call* call, bool hit, float overlap_x, float overlap_y) {
+	printf("  call %d %s(", index, sc2d_stats_name(call->function));
+	for (int i = 0; i < expected_args(call->function); i++) printf("%s%.9g", i ? ", " : "", call->args[i]);
+	for (int i = 0; i < call->poly_count; i++) printf(", <%d verts>", call->counts[i]);
+	printf(")\n    recorded %s", (call->flags & SC2D_TRACE_HIT) ? "hit" : "miss");
+	if ((call->flags & SC2D_TRACE_HIT) && call->overlap) printf(" %.9g %.9g", call->overlap[0], call->overlap[1]);
+	printf(", now %s", hit ? "hit" : "miss");
+	if (hit && call->overlap) printf(" %.9g %.9g", overlap_x, overlap_y);
+	printf("\n");
+}
+
+int main(int argc, char** argv) {
+	const char* path = 0;
+	double seconds = 0.2;
+	Mapping map;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--time") && i + 1 < argc) seconds = atof(argv[++i]);
+		else if (!path && argv[i][0] != '-') path = argv[i];
+		else path = 0, i = argc;
+	}
+	if (!path) {
+		fprintf(stderr, "Usage: %s TRACE [--time SECONDS]\n", argv[0]);
+		return 2;
+	}
+
+	if (!map_file(path, &map)) {
+		fprintf(stderr, "Could not map %s\n", path);
+		return 2;
+	}
+
+	sc2d_trace_header* header = (sc2d_trace_header*)map.data;
+	if (map.size < sizeof(sc2d_trace_header) || memcmp(header->magic, "sc2dtrc", 8) != 0 || header->version != SC2D_TRACE_VERSION) {
+		fprintf(stderr, "%s is not a version %d trace\n", path, SC2D_TRACE_VERSION);
+		return 2;
+	}
+	if (header->function_count != SC2D_STAT_FUNCTION_COUNT) {
+		fprintf(stderr, "%s was recorded by a build with %d functions, this build has %d\n", path, header->function_count, SC2D_STAT_FUNCTION_COUNT);
+		return 2;
+	}
+
+	size_t truncated = 0;
+	int call_count = parse_trace((char*)map.data, map.size, 0, &truncated);
+	if (call_count < 0) {
+		fprintf(stderr, "%s is corrupt\n", path);
+		return 2;
+	}
+
+	Call* calls = (Call*)malloc(sizeof(Call) * (call_count ? call_count : 1));
+	int* order = (int*)malloc(sizeof(int) * (call_count ? call_count : 1));
+	int first[SC2D_STAT_FUNCTION_COUNT + 1] = {0};
+	int hits[SC2D_STAT_FUNCTION_COUNT] = {0}, differences[SC2D_STAT_FUNCTION_COUNT] = {0};
+	int total_differences = 0;
+	parse_trace((char*)map.data, map.size, calls, &truncated);
+
+	// sc2d_poly checks get their polygons rebuilt from the recorded vertices, hull flag included
+	size_t storage_floats = 0;
+	for (int i = 0; i < call_count; i++) {
+		if (uses_polys(calls[i].function)) {
+			for (int j = 0; j < calls[i].poly_count; j++) storage_floats += (size_t)calls[i].counts[j] * 4;
+		}
+	}
+	float* storage = (float*)malloc(sizeof(float) * (storage_floats ? storage_floats : 1));
+	float* next_storage = storage;
+	for (int i = 0; i < call_count; i++) {
+		if (!uses_polys(calls[i].function)) continue;
+
+		for (int j = 0; j < calls[i].poly_count; j++) {
+			int hull = calls[i].polys[j].hull;
+			sc2d_poly_init(calls[i].polys + j, calls[i].verts[j], calls[i].counts[j], next_storage);
+			calls[i].polys[j].hull = hull;
+			next_storage += calls[i].counts[j] * 4;
+		}
+	}
+
+	printf("%s: %d calls\n", path, call_count);
+	if (truncated) printf("Ignoring the last %zu bytes, the recording ends in the middle of a call\n", truncated);
+
+	for (int i = 0; i < call_count; i++) {
+		float overlap_x = 0, overlap_y = 0;
+		bool hit = replay(calls + i, &overlap_x, &overlap_y);
+
+		hits[calls[i].function] += hit;
+		first[calls[i].function + 1]++;
+		if (!same_result(calls + i, hit, overlap_x, overlap_y)) {
+			if (total_differences++ < MAX_REPORTED) print_call(i, calls + i, hit, overlap_x, overlap_y);
+			differences[calls[i].function]++;
+		}
+	}
+	if (total_differences > MAX_REPORTED) printf("  ... and %d more\n", total_differences - MAX_REPORTED);
+
+	// Group the calls by function, in recorded order, for timing
+	for (int f = 0; f < SC2D_STAT_FUNCTION_COUNT; f++) first[f + 1] += first[f];
+	{
+		int fill[SC2D_STAT_FUNCTION_COUNT];
+		memcpy(fill, first, sizeof(fill));
+		for (int i = 0; i < call_count; i++) order[fill[calls[i].function]++] = i;
+	}
+
+	printf("\n%-34s %10s %10s %10s %10s\n", "function", "calls", "hits", "differ", "ns/call");
+
+	for (int f = 0; f < SC2D_STAT_FUNCTION_COUNT; f++) {
+		int count = first[f + 1] - first[f];
+		if (!count) continue;
+
+		float sink = 0;
+		long long runs = 0;
+		double start = now_seconds(), elapsed = 0;
+
+		do {
+			for (int i = first[f]; i < first[f + 1]; i++) {
+				float overlap_x = 0, overlap_y = 0;
+				sink += replay(calls + order[i], &overlap_x, &overlap_y) + overlap_x;
+			}
+			runs += count;
+			elapsed = now_seconds() - start;
+		} while (elapsed < seconds);
+
+		if (sink == 12345.0f) printf(" "); // Keep the results alive
+		printf("%-34s %10d %10d %10d %10.2f\n", sc2d_stats_name(f), count, hits[f], differences[f], elapsed * 1e9 / (double)runs);
+	}
+
+	free(storage);
+	free(order);
+	free(calls);
+	unmap_file(&map);
+	return total_differences ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+// Steps a scene of 50k circles, rects and n-gons in an sc2d_world, against the same scene kept as an sc2d_shape table
+// with separately allocated polygons, an sc2d_bvh and sc2d_collide_pairs. Runs with every shape moving and with
+// most shapes at rest, where the world only tests the moving ones. Headless, no raylib required.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#define SIMPLE_COLLISION_2D_IMPLEMENTATION 1
+#include "../sc2d.h"
+
+#include "bench_common.h"
+
+#define SHAPE_COUNT 50000
+#define WORLD_SIZE 4000.0f
+#define MAX_POLY_VERTS 8
+#define PAIR_CAPACITY (2 * SHAPE_COUNT)
+#define MARGIN 2.0f
+#define STEP_DISTANCE 0.25f			// Largest move per step on each axis
+#define MIN_SECONDS 1.0
+#define RESTING_SHARE 0.8f			// Share of shapes at rest in the second run
+
+static sc2d_shape shapes[SHAPE_COUNT];
+static sc2d_handle handles[SHAPE_COUNT];
+static int proxies[SHAPE_COUNT];
+static float dx[SHAPE_COUNT], dy[SHAPE_COUNT];
+static sc2d_pair pairs[PAIR_CAPACITY];
+static sc2d_hit hits[PAIR_CAPACITY];
+
+// Bounds of a table shape for the BVH, including polygon positions like the world does
+static void shape_bounds(sc2d_shape* s, float* x, float* y, float* w, float* h) {
+	switch (s->type) {
+		case SC2D_SHAPE_CIRCLE: *x = s->x - s->r; *y = s->y - s->r; *w = *h = 2 * s->r; break;
+		case SC2D_SHAPE_RECT: *x = s->x; *y = s->y; *w = s->w; *h = s->h; break;
+		default: {
+			float min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+			for (int i = 0; i < s->count; i++) {
+				min_x = fminf(min_x, s->verts[i * 2]);
+				min_y = fminf(min_y, s->verts[i * 2 + 1]);
+				max_x = fmaxf(max_x, s->verts[i * 2]);
+				max_y = fmaxf(max_y, s->verts[i * 2 + 1]);
+			}
+			*x = s->x + min_x; *y = s->y + min_y; *w = max_x - min_x; *h = max_y - min_y;
+			break;
+		}
+	}
+}
+
+// Shapes of 2-8 units spread over the world, each with a constant velocity that bounces off the world's edges
+static int generate_scene(void) {
+	int vert_count = 0;
+
+	for (int i = 0; i < SHAPE_COUNT; i++) {
+		sc2d_shape* s = shapes + i;
+		s->type = (int)random_float(0, 2.999f);
+		if (s->type == 2) s->type = SC2D_SHAPE_POLY;
+		s->x = random_float(0, WORLD_SIZE);
+		s->y = random_float(0, WORLD_SIZE);
+		s->w = random_float(2, 8);
+		s->h = random_float(2, 8);
+		s->r = random_float(1, 4);
+
+		if (s->type == SC2D_SHAPE_POLY) {
+			s->count = 3 + (int)random_float(0, MAX_POLY_VERTS - 3.001f);
+			s->verts = malloc(s->count * 2 * sizeof(float));
+			generate_polygon(s->verts, s->count, random_float(1, 4), random_float(0, 6.2831853f));
+			vert_count += s->count;
+		}
+
+		dx[i] = random_float(-STEP_DISTANCE, STEP_DISTANCE);
+		dy[i] = random_float(-STEP_DISTANCE, STEP_DISTANCE);
+	}
+
+	return vert_count;
+}
+
+static void advance(int i) {
+	sc2d_shape* s = shapes + i;
+	if (s->x + dx[i] < 0 || s->x + dx[i] > WORLD_SIZE) dx[i] = -dx[i];
+	if (s->y + dy[i] < 0 || s->y + dy[i] > WORLD_SIZE) dy[i] = -dy[i];
+	s->x += dx[i];
+	s->y += dy[i];
+}
+
+int main(void) {
+	int vert_count = generate_scene();
+
+	// World
+	size_t memory_size = sc2d_world_memory_size(SHAPE_COUNT, vert_count, PAIR_CAPACITY);
+	void* memory = malloc(memory_size);
+	sc2d_world world;
+	sc2d_world_init(&world, memory, memory_size, SHAPE_COUNT, vert_count, PAIR_CAPACITY, MARGIN);
+	for (int i = 0; i < SHAPE_COUNT; i++) handles[i] = sc2d_world_add(&world, shapes + i);
+
+	// Shape table
+	static sc2d_bvh_node nodes[2 * SHAPE_COUNT];
+	sc2d_bvh bvh;
+	sc2d_bvh_init(&bvh, nodes, 2 * SHAPE_COUNT, MARGIN);
+	for (int i = 0; i < SHAPE_COUNT; i++) {
+		float x, y, w, h;
+		shape_bounds(shapes + i, &x, &y, &w, &h);
+		proxies[i] = sc2d_bvh_insert(&bvh, i, x, y, w, h);
+	}
+
+	printf("%d shapes, %d polygon vertices, world memory %.1f MB\n", SHAPE_COUNT, vert_count, memory_size / 1e6);
+	printf("%-8s %-8s %12s %10s %8s\n", "version", "moving", "us/step", "pairs", "hits");
+
+	for (int run = 0; run < 4; run++) {
+		int version = run % 2;
+		int moving_count = (run < 2) ? SHAPE_COUNT : (int)(SHAPE_COUNT * (1.0f - RESTING_SHARE));
+		long long steps = 0;
+		int pair_count = 0, hit_count = 0;
+		double start = now_seconds(), elapsed = 0;
+
+		do {
+			if (version == 0) {
+				for (int i = 0; i < moving_count; i++) {
+					advance(i);
+					sc2d_world_move(&world, handles[i], shapes[i].x, shapes[i].y);
+				}
+
+				sc2d_world_hit* world_hits;
+				hit_count = sc2d_world_step(&world, &world_hits);
+				pair_count = world.pair_count;
+			} else {
+				for (int i = 0; i < moving_count; i++) {
+					float x, y, w, h;
+					advance(i);
+					shape_bounds(shapes + i, &x, &y, &w, &h);
+					sc2d_bvh_move(&bvh, proxies[i], x, y, w, h);
+				}
+
+				pair_count = sc2d_bvh_query_pairs(&bvh, &bvh, pairs, PAIR_CAPACITY);
+				if (pair_count < 0) pair_count = 0;
+				hit_count = sc2d_collide_pairs(shapes, pairs, pair_count < PAIR_CAPACITY ? pair_count : PAIR_CAPACITY, hits);
+			}
+
+			steps++;
+			elapsed = now_seconds() - start;
+		} while (elapsed < MIN_SECONDS);
+
+		printf("%-8s %7.0f%% %12.1f %10d %8d\n", version ? "table" : "world", 100.0 * moving_count / SHAPE_COUNT,
+			   elapsed * 1e6 / (double)steps, pair_count, hit_count);
+	}
+
+	return 0;
+}
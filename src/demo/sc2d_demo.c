@@ -25,6 +25,13 @@ typedef Vector3 sc2d_v2;
 #define POLYGON_SCALE 20.0f
 #define MAX_POLY_SIDES 12
 
+#define MAX_OBJECTS 16
+#define GRID_CELL_SIZE 64.0f
+#define GRID_BUCKETS 64
+#define GRID_ENTRIES 256
+#define MAX_PAIRS 128
+#define BVH_MARGIN 8.0f
+
 typedef struct Polygon {
 	Vector3 vertices[MAX_POLY_SIDES];
 	int vert_count;
@@ -103,20 +110,6 @@ Vector3 get_polygon_edge(Polygon p, int startIndex) {
 	return result;
 }
 
-Rectangle poly_to_rect(Vector3 position, Polygon p) {
-	Rectangle result = {0};
-
-	if (p.vert_count > 4) TraceLog(LOG_WARNING, "Converted poly with more than 4 vertices to rect.");
-
-	result.width = fabs(p.vertices[2].x - p.vertices[0].x);				
-	result.height = fabs(p.vertices[2].y - p.vertices[0].y);
-
-	result.x = position.x - result.width/2.0f;
-	result.y = position.y - result.height/2.0f;
-
-	return result;
-}
-
 void draw_polygon(Vector3 v, Polygon p, Color c) {
 	if (p.vert_count < 2) {
 		TraceLog(LOG_WARNING, "Polygon has less than 2 verts and was not drawn");
@@ -151,40 +144,62 @@ static void draw_object_label(Vector3 pos, int type) {
 	}
 }
 
-bool check_object_collision(Object obj1, Object obj2, Vector2* overlap) {
-	bool result = false;
-	Polygon p1, p2;
+// All shapes are generated with a radius of 1, so scale is the radius of their bounding circle
+static Rectangle object_bounds(Object obj) {
+	Rectangle result = {obj.position.x - obj.scale, obj.position.y - obj.scale, obj.scale * 2.0f, obj.scale * 2.0f};
+	return result;
+}
 
-	p1 = scale_polygon(obj1.shape, obj1.scale);
-	p1 = rotate_polygon(p1, obj1.rotation);
+// Placement of an object's local-space shape, so the collision checks never copy or transform its vertices
+static sc2d_transform object_transform(const Object* obj) {
+	float angle = obj->rotation * DEG2RAD;
+	sc2d_transform result = {obj->position.x, obj->position.y, cosf(angle), sinf(angle), obj->scale};
+	return result;
+}
 
-	p2 = scale_polygon(obj2.shape, obj2.scale);
-	p2 = rotate_polygon(p2, obj2.rotation);
+// Axis aligned rect of a rectangle object, from two opposite corners of its shape
+static Rectangle object_rect(const Object* obj) {
+	sc2d_transform t = object_transform(obj);
+	Vector3 v0 = obj->shape.vertices[0], v2 = obj->shape.vertices[2];
+	Rectangle result = {0};
 
-	switch (obj1.type) {
+	// Only the rotated corner difference is needed, the position is the rect's center
+	float dx = (v2.x - v0.x) * t.scale, dy = (v2.y - v0.y) * t.scale;
+	result.width = fabs(t.cos * dx - t.sin * dy);
+	result.height = fabs(t.sin * dx + t.cos * dy);
+
+	result.x = obj->position.x - result.width/2.0f;
+	result.y = obj->position.y - result.height/2.0f;
+
+	return result;
+}
+
+bool check_object_collision(const Object* obj1, const Object* obj2, Vector2* overlap) {
+	bool result = false;
+	sc2d_transform t1 = object_transform(obj1);
+	sc2d_transform t2 = object_transform(obj2);
+
+	switch (obj1->type) {
 		// obj1 is a circle
 		case OBJECT_TYPE_CIRCLE: {
-			switch (obj2.type) {
+			switch (obj2->type) {
 				case OBJECT_TYPE_CIRCLE:
-					result = sc2d_check_circles(obj1.position.x, obj1.position.y, obj1.scale, 
-												obj2.position.x, obj2.position.y, obj2.scale, 
+					result = sc2d_check_circles(obj1->position.x, obj1->position.y, obj1->scale, 
+												obj2->position.x, obj2->position.y, obj2->scale, 
 												&overlap->x, &overlap->y);
 					break;
 				case OBJECT_TYPE_RECTANGLE: {
-					Rectangle rect = poly_to_rect(obj2.position, p2);
-					result = sc2d_check_circle_rect(obj1.position.x, obj1.position.y, obj1.scale, 
+					Rectangle rect = object_rect(obj2);
+					result = sc2d_check_circle_rect(obj1->position.x, obj1->position.y, obj1->scale, 
 													rect.x, rect.y, rect.width, rect.height,
 													&overlap->x, &overlap->y);
 				}
 
 					break;
 				case OBJECT_TYPE_POLYGON: {
-					p1 = generate_polygon(MAX_POLY_SIDES); // circle
-					p1 = scale_polygon(p1, obj1.scale);
-
-					result = sc2d_check_poly2d(	obj1.position.x, obj1.position.y, (float*)p1.vertices, p1.vert_count, 
-												obj2.position.x, obj2.position.y, (float*)p2.vertices, p2.vert_count,
-												&overlap->x, &overlap->y);
+					result = sc2d_check_circle_poly2d_transformed(	obj1->position.x, obj1->position.y, obj1->scale,
+																	(float*)obj2->shape.vertices, obj2->shape.vert_count, &t2,
+																	&overlap->x, &overlap->y);
 				} break;
 				
 				default:
@@ -194,28 +209,28 @@ bool check_object_collision(Object obj1, Object obj2, Vector2* overlap) {
 		
 		// obj1 is a rectangle
 		case OBJECT_TYPE_RECTANGLE: {
-			switch (obj2.type) {
+			switch (obj2->type) {
 				case OBJECT_TYPE_CIRCLE: {
-					Rectangle rect = poly_to_rect(obj1.position, p1);
+					Rectangle rect = object_rect(obj1);
 
-					result = sc2d_check_circle_rect(obj2.position.x, obj2.position.y, obj2.scale, 
+					result = sc2d_check_circle_rect(obj2->position.x, obj2->position.y, obj2->scale, 
 													rect.x, rect.y, rect.width, rect.height,
 													&overlap->x, &overlap->y);
 					*overlap = Vector2Scale(*overlap, -1.0f); // Flip the overlap, because the circle is the second object
 				} break;
 				
 				case OBJECT_TYPE_RECTANGLE:{
-					Rectangle rect1 = poly_to_rect(obj1.position, p1);
-					Rectangle rect2 = poly_to_rect(obj2.position, p2);
+					Rectangle rect1 = object_rect(obj1);
+					Rectangle rect2 = object_rect(obj2);
 
 					result = sc2d_check_rects(	rect1.x, rect1.y, rect1.width, rect1.height, 
 												rect2.x, rect2.y, rect2.width, rect2.height,
 												&overlap->x, &overlap->y);
 				} break;
 				case OBJECT_TYPE_POLYGON: {
-					result = sc2d_check_poly2d(	obj1.position.x, obj1.position.y, (float*)p1.vertices, p1.vert_count, 
-												obj2.position.x, obj2.position.y, (float*)p2.vertices, p2.vert_count,
-												&overlap->x, &overlap->y);
+					result = sc2d_check_poly2d_transformed(	(float*)obj1->shape.vertices, obj1->shape.vert_count, &t1,
+															(float*)obj2->shape.vertices, obj2->shape.vert_count, &t2,
+															&overlap->x, &overlap->y);
 				} break;
 				
 				default:
@@ -225,26 +240,19 @@ bool check_object_collision(Object obj1, Object obj2, Vector2* overlap) {
 		
 		//obj1 is a polygon
 		case OBJECT_TYPE_POLYGON: {
-			switch (obj2.type) {
+			switch (obj2->type) {
 				case OBJECT_TYPE_CIRCLE: {
-					p2 = generate_polygon(MAX_POLY_SIDES); // circle
-					p2 = scale_polygon(p2, obj2.scale);
-
-					result = sc2d_check_poly2d(	obj1.position.x, obj1.position.y, (float*)p1.vertices, p1.vert_count, 
-												obj2.position.x, obj2.position.y, (float*)p2.vertices, p2.vert_count,
-												&overlap->x, &overlap->y);
+					result = sc2d_check_circle_poly2d_transformed(	obj2->position.x, obj2->position.y, obj2->scale,
+																	(float*)obj1->shape.vertices, obj1->shape.vert_count, &t1,
+																	&overlap->x, &overlap->y);
+					*overlap = Vector2Scale(*overlap, -1.0f); // Flip the overlap, because the circle is the second object
 				} break;
 
-				case OBJECT_TYPE_RECTANGLE: {
-					result = sc2d_check_poly2d(	obj1.position.x, obj1.position.y, (float*)p1.vertices, p1.vert_count, 
-												obj2.position.x, obj2.position.y, (float*)p2.vertices, p2.vert_count,
-												&overlap->x, &overlap->y);
-				} break;
-				
-				case OBJECT_TYPE_POLYGON: {				
-					result = sc2d_check_poly2d(	obj1.position.x, obj1.position.y, (float*)p1.vertices, p1.vert_count, 
-												obj2.position.x, obj2.position.y, (float*)p2.vertices, p2.vert_count,
-												&overlap->x, &overlap->y);
+				case OBJECT_TYPE_RECTANGLE:
+				case OBJECT_TYPE_POLYGON: {
+					result = sc2d_check_poly2d_transformed(	(float*)obj1->shape.vertices, obj1->shape.vert_count, &t1,
+															(float*)obj2->shape.vertices, obj2->shape.vert_count, &t2,
+															&overlap->x, &overlap->y);
 				} break;
 
 				default: {} break;
@@ -285,6 +293,25 @@ int main(void) {
 	}
 
 	int shape_grabbed = -1;
+
+	// Broadphase: object bounds are rebuilt into the grid every frame and only the candidate pairs are checked
+	float bounds_x[MAX_OBJECTS], bounds_y[MAX_OBJECTS], bounds_w[MAX_OBJECTS], bounds_h[MAX_OBJECTS];
+	int grid_buckets[GRID_BUCKETS + 1];
+	sc2d_grid_entry grid_entries[GRID_ENTRIES];
+	sc2d_pair pairs[MAX_PAIRS];
+	sc2d_grid grid;
+	sc2d_grid_init(&grid, GRID_CELL_SIZE, grid_buckets, GRID_BUCKETS, grid_entries, GRID_ENTRIES);
+
+	// Object bounds are also kept in a tree, so clicks only test the objects under the mouse
+	sc2d_bvh_node bvh_nodes[MAX_OBJECTS * 2];
+	int proxies[MAX_OBJECTS];
+	int candidates[MAX_OBJECTS];
+	sc2d_bvh bvh;
+	sc2d_bvh_init(&bvh, bvh_nodes, MAX_OBJECTS * 2, BVH_MARGIN);
+	for (int i = 0; i < arrayLength(objects); i++) {
+		Rectangle bounds = object_bounds(objects[i]);
+		proxies[i] = sc2d_bvh_insert(&bvh, i, bounds.x, bounds.y, bounds.width, bounds.height);
+	}
 	
 	SetTargetFPS(60);
 	InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Simple Collision 2D");
@@ -295,8 +322,15 @@ int main(void) {
 		Vector2 overlap = {0};
 
 		if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-			for (int i = 0; i < arrayLength(objects); i++) {
+			int candidate_count = sc2d_bvh_query_point(&bvh, mouse_position.x, mouse_position.y, candidates, MAX_OBJECTS);
+			if (candidate_count > MAX_OBJECTS) candidate_count = MAX_OBJECTS;
+
+			// Grab the first object in the array that is under the mouse
+			for (int c = 0; c < candidate_count; c++) {
+				int i = candidates[c];
 				bool hit = false;
+				if (shape_grabbed >= 0 && shape_grabbed < i) continue;
+
 				if (objects[i].type == OBJECT_TYPE_CIRCLE) {
 					hit = sc2d_check_point_circle(	mouse_position.x, mouse_position.y, 
 													objects[i].position.x, objects[i].position.y, objects[i].scale, &overlap.x, &overlap.y);
@@ -308,10 +342,7 @@ int main(void) {
 					hit = sc2d_check_point_poly2d(mouse_position.x, mouse_position.y, (float*)p.vertices, p.vert_count);
 				}
 
-				if (hit) {
-					shape_grabbed = i;
-					break;
-				}
+				if (hit) shape_grabbed = i;
 			}
 		}
 
@@ -326,29 +357,51 @@ int main(void) {
 		
 		}
 		
+		for (int i = 0; i < arrayLength(objects); i++) {
+			Rectangle bounds = object_bounds(objects[i]);
+			bounds_x[i] = bounds.x;
+			bounds_y[i] = bounds.y;
+			bounds_w[i] = bounds.width;
+			bounds_h[i] = bounds.height;
+			objects[i].hit = false;
+		}
+
+		int pair_count = 0;
+		if (sc2d_grid_build(&grid, bounds_x, bounds_y, bounds_w, bounds_h, arrayLength(objects))) {
+			pair_count = sc2d_grid_pairs(&grid, bounds_x, bounds_y, bounds_w, bounds_h, pairs, MAX_PAIRS);
+			if (pair_count > MAX_PAIRS) pair_count = MAX_PAIRS;
+		}
+
+		for (int p = 0; p < pair_count; p++) {
+			int i = pairs[p].a;
+			int e = pairs[p].b;
+			overlap = (Vector2){0};
+
+			bool hit = check_object_collision(&objects[i], &objects[e], &overlap);
+
+			if (hit) {
+				objects[i].hit = objects[e].hit = true;
+				if (i == shape_grabbed) {
+					Vector2 v = Vector2Add((Vector2){objects[e].position.x, objects[e].position.y}, overlap);
+					objects[e].position = (Vector3){v.x, v.y, 0};
+				} else {
+					Vector2 v = Vector2Subtract((Vector2){objects[i].position.x, objects[i].position.y}, overlap);
+					objects[i].position = (Vector3){v.x, v.y, 0};
+				}
+			}
+		}
+
+		for (int i = 0; i < arrayLength(objects); i++) {
+			Rectangle bounds = object_bounds(objects[i]);
+			sc2d_bvh_move(&bvh, proxies[i], bounds.x, bounds.y, bounds.width, bounds.height);
+		}
+		
 		BeginDrawing();
 			ClearBackground((Color){0,0,0,255});
 			Polygon p = {0};
 			for (int i = 0; i < arrayLength(objects); i++) {
 				Color color = (shape_grabbed == i) ? YELLOW : WHITE;
-
-				for (int e = i+1; e < arrayLength(objects); e++) {
-					//if (e == i) continue;
-					overlap = (Vector2){0};
-					
-					bool hit = check_object_collision(objects[i], objects[e], &overlap);
-
-					if (hit) {
-						color = RED;
-						if (i == shape_grabbed) {
-							Vector2 v = Vector2Add((Vector2){objects[e].position.x, objects[e].position.y}, overlap);
-							objects[e].position = (Vector3){v.x, v.y, 0};
-						} else {
-							Vector2 v = Vector2Subtract((Vector2){objects[i].position.x, objects[i].position.y}, overlap);
-							objects[i].position = (Vector3){v.x, v.y, 0};
-						}
-					}
-				}
+				if (objects[i].hit) color = RED;
 
 				if (objects[i].type == OBJECT_TYPE_CIRCLE) {
 					DrawCircleLines(objects[i].position.x, objects[i].position.y, objects[i].scale, color);
@@ -5,6 +5,22 @@
 
 #define SIMPLE_COLLISION_2D_H 
 #include <stdbool.h>
+#include <stddef.h>
+
+#if defined(SIMPLE_COLLISION_2D_THREADS) || defined(SIMPLE_COLLISION_2D_TRACE)
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 bool sc2d_check_point_circle(float px, float py, float cx, float xy, float cr, float* overlap_x, float* overlap_y);
 bool sc2d_check_point_rect(float px, float py, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y);
@@ -13,12 +29,520 @@ bool sc2d_check_rects(float p1x, float p1y, float r1w, float r1h, float p2x, flo
 bool sc2d_check_circle_centered_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y);
 bool sc2d_check_circle_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y);
 
+// Boolean-only versions of the circle checks: same hit/miss result, no overlap and no square roots
+bool sc2d_test_point_circle(float px, float py, float cx, float cy, float cr);
+bool sc2d_test_circles(float p1x, float p1y, float r1, float p2x, float p2y, float r2);
+bool sc2d_test_circle_centered_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh);
+bool sc2d_test_circle_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh);
+bool sc2d_test_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count);
+
 bool sc2d_check_poly2d(	float p1x, float p1y, float* p1_verts, int p1_count, 
 							float p2x, float p2y, float* p2_verts, int p2_count, 
 							float* overlap_x, float* overlap_y);
+bool sc2d_check_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count, float* overlap_x, float* overlap_y);
 bool sc2d_check_point_poly2d(float px, float py, float* poly_verts, int vert_count);
 bool sc2d_check_point_line(float px, float py, float start_x, float start_y, float end_x, float end_y, bool segment);
 
+// Same checks, first rejecting polygons whose bounding circles do not touch. The radii (distance from the position to
+// the farthest vertex) are computed once with sc2d_poly2d_radius, e.g. when the polygon is created.
+float sc2d_poly2d_radius(float* poly_verts, int vert_count);
+bool sc2d_check_poly2d_bounded(	float p1x, float p1y, float* p1_verts, int p1_count, float p1_radius,
+								float p2x, float p2y, float* p2_verts, int p2_count, float p2_radius,
+								float* overlap_x, float* overlap_y);
+bool sc2d_check_point_poly2d_bounded(float px, float py, float* poly_verts, int vert_count, float radius);
+
+// Vertices read in place from a caller's buffer, e.g. positions interleaved with uvs and colors in a render vertex
+// Vertex i is at base + i * stride, with its x and y floats at offset_x and offset_y. All sizes are in bytes.
+typedef struct sc2d_verts {
+	void* base;
+	int stride;
+	int offset_x, offset_y;
+	int count;
+} sc2d_verts;
+
+bool sc2d_check_poly2d_strided(float p1x, float p1y, sc2d_verts* p1, float p2x, float p2y, sc2d_verts* p2, float* overlap_x, float* overlap_y);
+bool sc2d_check_circle_poly2d_strided(float cx, float cy, float cr, float px, float py, sc2d_verts* poly, float* overlap_x, float* overlap_y);
+bool sc2d_check_point_poly2d_strided(float px, float py, sc2d_verts* poly);
+
+// Separating axis cache for one polygon pair, owned by the caller and zero initialized
+typedef struct sc2d_sat_cache {
+	unsigned short edge;		// Edge whose normal separated the pair on the last call
+	unsigned char poly;			// 1 or 2: polygon the edge belongs to, 0: no cached axis
+	unsigned char reserved;
+} sc2d_sat_cache;
+
+bool sc2d_check_poly2d_cached(	float p1x, float p1y, float* p1_verts, int p1_count, 
+								float p2x, float p2y, float* p2_verts, int p2_count, 
+								sc2d_sat_cache* cache, float* overlap_x, float* overlap_y);
+
+// Convex polygon with precomputed edge normals and bounds, built once with sc2d_poly_init
+typedef struct sc2d_poly {
+	float* verts;				// count x/y pairs, relative to the polygon's position
+	float* normals;				// count unit edge normals (edge i goes from vertex i to vertex i + 1)
+	int count;
+	float centroid_x, centroid_y;
+	float radius;				// Distance from the position to the farthest vertex
+	float min_x, min_y, max_x, max_y;	// Bounds relative to the position
+	int hull;					// Set by sc2d_poly_make_hull: strictly convex with a fixed winding, searched in O(log n)
+} sc2d_poly;
+
+void sc2d_poly_init(sc2d_poly* poly, float* verts, int count, float* storage);
+void sc2d_poly_init_strided(sc2d_poly* poly, sc2d_verts* verts, float* storage);
+bool sc2d_poly_make_hull(sc2d_poly* poly);
+bool sc2d_check_polys(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2, float* overlap_x, float* overlap_y);
+bool sc2d_check_polys_cached(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2,
+							 sc2d_sat_cache* cache, float* overlap_x, float* overlap_y);
+bool sc2d_check_point_poly(float px, float py, float x, float y, sc2d_poly* poly);
+bool sc2d_check_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly, float* overlap_x, float* overlap_y);
+bool sc2d_test_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly);
+
+// Placement of a local-space shape: world = position + rotation * (scale * local)
+// Rotation is passed as a precomputed cosine and sine, scale must be positive.
+typedef struct sc2d_transform {
+	float x, y;
+	float cos, sin;
+	float scale;
+} sc2d_transform;
+
+bool sc2d_check_poly2d_transformed(	float* p1_verts, int p1_count, sc2d_transform* t1,
+									float* p2_verts, int p2_count, sc2d_transform* t2,
+									float* overlap_x, float* overlap_y);
+bool sc2d_check_polys_transformed(sc2d_poly* p1, sc2d_transform* t1, sc2d_poly* p2, sc2d_transform* t2, float* overlap_x, float* overlap_y);
+bool sc2d_check_circle_poly2d_transformed(float cx, float cy, float cr, float* poly_verts, int vert_count, sc2d_transform* t,
+										  float* overlap_x, float* overlap_y);
+
+// Convex shape for the support function based checks (GJK/EPA)
+enum { SC2D_SHAPE_CIRCLE, SC2D_SHAPE_RECT, SC2D_SHAPE_CAPSULE, SC2D_SHAPE_POLY };
+
+typedef struct sc2d_shape {
+	int type;
+	float x, y;					// Center of circles, capsules and polygons. Left x, top y of rects.
+	float w, h;					// Rect width and height. Capsule segment runs from (x - w, y - h) to (x + w, y + h).
+	float r;					// Circle and capsule radius
+	float* verts;				// Polygon vertices relative to (x, y): count x/y pairs (or custom sc2d_v2 structs)
+	int count;
+	bool packed;				// verts are packed x/y pairs, like the vertices of an sc2d_poly, even with a custom sc2d_v2
+} sc2d_shape;
+
+void sc2d_shape_support(sc2d_shape* shape, float dir_x, float dir_y, float* support_x, float* support_y);
+bool sc2d_check_gjk(sc2d_shape* s1, sc2d_shape* s2);
+bool sc2d_check_shapes(sc2d_shape* s1, sc2d_shape* s2, float* overlap_x, float* overlap_y);
+bool sc2d_collide(sc2d_shape* s1, sc2d_shape* s2, float* overlap_x, float* overlap_y);
+
+// Pair of shape indices used by the batch functions
+typedef struct sc2d_pair {
+	int a, b;
+} sc2d_pair;
+
+// Batch collision result: indices of the colliding shapes and the overlap relative to shape a
+typedef struct sc2d_hit {
+	int a, b;
+	float overlap_x, overlap_y;
+} sc2d_hit;
+
+int sc2d_check_circles_batch(float* x, float* y, float* r, sc2d_pair* pairs, int pair_count, sc2d_hit* hits);
+int sc2d_check_circle_many(float px, float py, float pr, float* x, float* y, float* r, int count, sc2d_hit* hits);
+int sc2d_check_rects_batch(float* x, float* y, float* w, float* h, sc2d_pair* pairs, int pair_count,
+						   unsigned char* hit_mask, float* overlap_x, float* overlap_y);
+int sc2d_collide_pairs(sc2d_shape* shapes, sc2d_pair* pairs, int pair_count, sc2d_hit* hits);
+
+// Segment casts from start to end: the first hit's fraction along the segment (0 to 1) and the surface normal
+// Segments that start inside a shape hit it at fraction 0, with the normal opposite to the segment's direction.
+bool sc2d_raycast_circle(float start_x, float start_y, float end_x, float end_y, float cx, float cy, float cr,
+						 float* fraction, float* normal_x, float* normal_y);
+bool sc2d_raycast_rect(float start_x, float start_y, float end_x, float end_y, float rx, float ry, float rw, float rh,
+					   float* fraction, float* normal_x, float* normal_y);
+bool sc2d_raycast_poly2d(float start_x, float start_y, float end_x, float end_y, float px, float py, float* poly_verts, int vert_count,
+						 float* fraction, float* normal_x, float* normal_y);
+bool sc2d_raycast_poly(float start_x, float start_y, float end_x, float end_y, float x, float y, sc2d_poly* poly,
+					   float* fraction, float* normal_x, float* normal_y);
+bool sc2d_raycast_shape(float start_x, float start_y, float end_x, float end_y, sc2d_shape* shape,
+						float* fraction, float* normal_x, float* normal_y);
+
+typedef struct sc2d_ray {
+	float start_x, start_y, end_x, end_y;
+} sc2d_ray;
+
+// Closest hit of one ray: index of the shape (-1 if none), fraction along the ray and surface normal
+typedef struct sc2d_ray_hit {
+	int shape;
+	float fraction;
+	float normal_x, normal_y;
+} sc2d_ray_hit;
+
+int sc2d_raycast_shapes(sc2d_ray* rays, int ray_count, sc2d_shape* shapes, int shape_count, sc2d_ray_hit* hits);
+
+// Swept tests: both shapes move by their velocity (v1, v2) over one step. Return the earliest time of impact in [0, 1]
+// and the unit contact normal, pointing from the first shape toward the second like the overlap of the static checks.
+// Shapes that already overlap at the start hit at time 0, with the normal along which the static check separates them.
+bool sc2d_sweep_circles(float p1x, float p1y, float r1, float v1x, float v1y, float p2x, float p2y, float r2, float v2x, float v2y,
+						float* toi, float* normal_x, float* normal_y);
+bool sc2d_sweep_circle_rect(float cx, float cy, float cr, float v1x, float v1y, float rx, float ry, float rw, float rh, float v2x, float v2y,
+							float* toi, float* normal_x, float* normal_y);
+bool sc2d_sweep_rects(float p1x, float p1y, float r1w, float r1h, float v1x, float v1y, float p2x, float p2y, float r2w, float r2h, float v2x, float v2y,
+					  float* toi, float* normal_x, float* normal_y);
+bool sc2d_sweep_circle_poly2d(float cx, float cy, float cr, float v1x, float v1y, float px, float py, float* poly_verts, int vert_count,
+							  float v2x, float v2y, float* toi, float* normal_x, float* normal_y);
+
+// Contact feature id: which features of the two shapes touch. It stays the same while the contact persists.
+// Bits 0-13 hold the reference edge and bits 14-27 the incident vertex, so polygons are limited to 16384 vertices.
+#define SC2D_FEATURE_CORNER		(1u << 28)	// Circle touching the incident vertex instead of the reference edge
+#define SC2D_FEATURE_CLIPPED	(1u << 30)	// Point where a side of the reference edge clips the incident edge, replacing the incident vertex
+#define SC2D_FEATURE_FLIP		(1u << 31)	// Reference edge on the second shape
+#define SC2D_FEATURE_EDGE(id)	((int)((id) & 0x3fffu))
+#define SC2D_FEATURE_VERTEX(id)	((int)(((id) >> 14) & 0x3fffu))
+
+typedef struct sc2d_contact {
+	float x, y;					// World position, midway between the two surfaces
+	float depth;				// Penetration along the manifold normal
+	unsigned int id;			// Feature id (SC2D_FEATURE_*)
+	float normal_impulse;		// Solver impulses, carried over to the contact with the same id on the next update
+	float tangent_impulse;
+} sc2d_contact;
+
+// Contact manifold of one shape pair, owned by the caller and zero initialized, one per pair
+// Keeping it between frames lets the manifold functions warm start persisting contacts and reject separated pairs
+// along the last separating axis first.
+typedef struct sc2d_manifold {
+	float normal_x, normal_y;	// Unit normal from the first shape toward the second
+	sc2d_contact contacts[2];
+	int count;
+	sc2d_sat_cache cache;
+} sc2d_manifold;
+
+bool sc2d_manifold_poly2d(	float p1x, float p1y, float* p1_verts, int p1_count,
+							float p2x, float p2y, float* p2_verts, int p2_count,
+							sc2d_manifold* manifold);
+bool sc2d_manifold_polys(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2, sc2d_manifold* manifold);
+bool sc2d_manifold_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count, sc2d_manifold* manifold);
+bool sc2d_manifold_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly, sc2d_manifold* manifold);
+
+// Grid of solid tiles, read in place. Cells outside the grid are empty.
+typedef struct sc2d_tilemap {
+	unsigned char* cells;		// One byte per cell (nonzero is solid), or one bit per cell if bits is set
+	int width, height;			// In cells
+	int stride;					// Bytes per row
+	bool bits;					// Bit-packed rows: cell x of a row is bit (x & 7) of byte (x >> 3)
+	float x, y;					// Top-left corner of cell (0, 0)
+	float cell_size;
+} sc2d_tilemap;
+
+// Check a shape against every solid cell it covers at once, with one overlap for all of them
+bool sc2d_check_rect_tilemap(float rx, float ry, float rw, float rh, sc2d_tilemap* map, float* overlap_x, float* overlap_y);
+bool sc2d_check_circle_tilemap(float cx, float cy, float cr, sc2d_tilemap* map, float* overlap_x, float* overlap_y);
+
+// Uniform grid broadphase (spatial hash)
+// All memory is owned by the caller, so building and querying the grid never allocates.
+typedef struct sc2d_grid_entry {
+	int id;
+	int cell_x, cell_y;
+} sc2d_grid_entry;
+
+typedef struct sc2d_grid {
+	float cell_size, inv_cell_size;
+	int* buckets;				// bucket_count + 1 offsets into entries
+	int bucket_count;			// Must be a power of two
+	sc2d_grid_entry* entries;	// One entry per object per overlapped cell
+	int entry_capacity;
+	int entry_count;
+} sc2d_grid;
+
+void sc2d_grid_init(sc2d_grid* grid, float cell_size, int* buckets, int bucket_count, sc2d_grid_entry* entries, int entry_capacity);
+bool sc2d_grid_build(sc2d_grid* grid, float* x, float* y, float* w, float* h, int count);
+int sc2d_grid_pairs(sc2d_grid* grid, float* x, float* y, float* w, float* h, sc2d_pair* pairs, int pair_capacity);
+int sc2d_grid_query(sc2d_grid* grid, float* x, float* y, float* w, float* h,
+					float qx, float qy, float qw, float qh, int* results, int result_capacity);
+
+// Incremental sweep and prune broadphase
+// Keeps sorted endpoint lists between updates and reports pairs that start or stop overlapping.
+typedef struct sc2d_sap_endpoint {
+	float value;
+	int id;						// Object index * 2, + 1 for max endpoints
+} sc2d_sap_endpoint;
+
+typedef struct sc2d_sap {
+	sc2d_sap_endpoint* axis_x;	// 2 * count endpoints, sorted along x
+	sc2d_sap_endpoint* axis_y;	// 2 * count endpoints, sorted along y
+	float* bounds;				// min x, min y, max x, max y of each object
+	int count;
+} sc2d_sap;
+
+void sc2d_sap_init(sc2d_sap* sap, sc2d_sap_endpoint* endpoints, float* bounds, float* x, float* y, float* w, float* h, int count);
+int sc2d_sap_pairs(sc2d_sap* sap, sc2d_pair* pairs, int pair_capacity);
+void sc2d_sap_update(sc2d_sap* sap, float* x, float* y, float* w, float* h,
+					 sc2d_pair* added, int added_capacity, int* added_count,
+					 sc2d_pair* removed, int removed_capacity, int* removed_count);
+
+// Dynamic bounding volume hierarchy (AABB tree)
+// Leaves store enlarged ("fat") bounds, so objects can move a little without being reinserted.
+typedef struct sc2d_bvh_node {
+	float min_x, min_y, max_x, max_y;
+	int parent;					// Next free node while the node is unused
+	int left, right;			// -1 for leaves
+	int height;					// 0 for leaves, -1 for unused nodes
+	int id;						// User id of leaves
+} sc2d_bvh_node;
+
+typedef struct sc2d_bvh {
+	sc2d_bvh_node* nodes;		// A tree with n leaves uses 2n - 1 nodes
+	int capacity;
+	int root;
+	int free_list;
+	float margin;				// Distance leaf bounds are enlarged by on each side
+} sc2d_bvh;
+
+void sc2d_bvh_init(sc2d_bvh* bvh, sc2d_bvh_node* nodes, int capacity, float margin);
+int sc2d_bvh_insert(sc2d_bvh* bvh, int id, float x, float y, float w, float h);
+void sc2d_bvh_remove(sc2d_bvh* bvh, int proxy);
+bool sc2d_bvh_move(sc2d_bvh* bvh, int proxy, float x, float y, float w, float h);
+int sc2d_bvh_query_rect(sc2d_bvh* bvh, float x, float y, float w, float h, int* results, int result_capacity);
+int sc2d_bvh_query_point(sc2d_bvh* bvh, float px, float py, int* results, int result_capacity);
+int sc2d_bvh_query_ray(sc2d_bvh* bvh, float start_x, float start_y, float end_x, float end_y, int* results, int result_capacity);
+int sc2d_bvh_query_pairs(sc2d_bvh* bvh1, sc2d_bvh* bvh2, sc2d_pair* pairs, int pair_capacity);
+
+// Shape world: a BVH broadphase and sc2d_collide narrowphase over shapes stored by the world
+// Shapes live in slots. What every step reads (type, position, size, radius, bounds) is kept in separate arrays,
+// and polygon vertices are copied into one arena, so a step streams through a few dense arrays.
+// Pairs are kept between steps and only retested when one of their shapes moved, and shapes that stay at rest
+// fall asleep in islands. Pairs of sleeping shapes are set aside with their hits, so a step costs about as much as
+// its awake shapes and their pairs.
+// All memory comes from one caller-owned block (see sc2d_world_memory_size), nothing is allocated.
+typedef unsigned int sc2d_handle;	// Slot index and generation. 0 is never a valid handle.
+
+#ifndef SC2D_WORLD_INDEX_BITS
+#define SC2D_WORLD_INDEX_BITS 20	// Maximum shape capacity is 1 << SC2D_WORLD_INDEX_BITS
+#endif
+
+// Colliding pair found by sc2d_world_step, with the overlap relative to shape a
+typedef struct sc2d_world_hit {
+	sc2d_handle a, b;
+	float overlap_x, overlap_y;
+} sc2d_world_hit;
+
+// Pair of shapes whose BVH leaf bounds overlap, with the result of its last test
+typedef struct sc2d_world_pair {
+	int a, b;					// Slots, a below b
+	float overlap_x, overlap_y;
+	bool hit;
+} sc2d_world_pair;
+
+typedef struct sc2d_world {
+	int capacity;				// Shape slots
+	int slot_count;				// Slots used so far, including free ones
+	int shape_count;
+	int free_slot;				// First free slot, -1 if none
+
+	// Hot arrays, one entry per slot
+	unsigned char* type;		// SC2D_SHAPE_*, or 0xff for free slots
+	unsigned char* flags;		// Changes since the last step and sleeping state
+	float *x, *y, *w, *h, *r;	// Like sc2d_shape
+	float* bounds;				// min x, min y, max x, max y of each shape
+
+	// Cold arrays, one entry per slot
+	float* local_bounds;		// bounds relative to the shape's position
+	float* leaf_bounds;			// BVH leaf bounds at the last step
+	unsigned int* generation;
+	int* proxy;					// BVH proxy, next free slot while the slot is free
+	int* vert_offset;			// First vertex in the arena
+	int* vert_count;
+	unsigned int* moved_step;	// Last step the shape moved or overlapped enough to stay awake
+	int* island;				// Union-find parent while sleeping islands are built
+	int* island_next;			// Next shape of a sleeping island, a ring
+	int* awake_index;			// Position in the awake list
+
+	// Vertex arena, in the layout sc2d_collide reads (x/y pairs or custom sc2d_v2 structs)
+	float* verts;
+	int* vert_owner;			// Slot of the polygon starting at each arena vertex, -1 - length at the start of holes
+	int vert_stride;			// Floats per vertex
+	int vert_capacity;
+	int vert_used;				// Arena end, including holes
+	int vert_free;				// Vertices in holes
+
+	int* dirty;					// Shapes added or moved since the last step
+	int dirty_count;
+	int* awake;					// Shapes that are not sleeping
+	int awake_count;
+
+	sc2d_bvh bvh;
+	sc2d_world_pair* pairs;		// Every pair whose leaf bounds overlap
+	int pair_count;
+	int sleeping_pair_count;	// Pairs at the start of pairs whose shapes were both asleep when they were set aside
+	sc2d_pair* candidates;		// BVH query results
+	sc2d_world_hit* hits;		// Hits of the last step
+	int hit_count;
+	int sleeping_hit_count;		// Hits of the sleeping pairs, kept at the start of hits between steps
+	bool woke;					// An island woke since the sleeping pairs were set aside
+	int pair_capacity;			// Size of pairs, candidates and hits
+	int test_count;				// Pairs the last step ran sc2d_collide on
+	int dropped;				// Pairs the last step lost because pairs or candidates was full (+1 per BVH query that overflowed)
+	unsigned int step;
+} sc2d_world;
+
+size_t sc2d_world_memory_size(int shape_capacity, int vert_capacity, int pair_capacity);
+bool sc2d_world_init(sc2d_world* world, void* memory, size_t memory_size, int shape_capacity, int vert_capacity,
+					 int pair_capacity, float margin);
+sc2d_handle sc2d_world_add(sc2d_world* world, sc2d_shape* shape);
+void sc2d_world_remove(sc2d_world* world, sc2d_handle handle);
+bool sc2d_world_valid(sc2d_world* world, sc2d_handle handle);
+void sc2d_world_move(sc2d_world* world, sc2d_handle handle, float x, float y);
+bool sc2d_world_get(sc2d_world* world, sc2d_handle handle, sc2d_shape* shape);
+bool sc2d_world_sleeping(sc2d_world* world, sc2d_handle handle);
+void sc2d_world_wake(sc2d_world* world, sc2d_handle handle);
+int sc2d_world_step(sc2d_world* world, sc2d_world_hit** hits);
+
+// Functions counted by SIMPLE_COLLISION_2D_STATS and recorded by SIMPLE_COLLISION_2D_TRACE. Functions built on other sc2d
+// functions count those calls too (sc2d_check_circle_rect also counts one sc2d_check_circle_centered_rect call).
+enum {
+	SC2D_STAT_POINT_CIRCLE,
+	SC2D_STAT_POINT_RECT,
+	SC2D_STAT_CIRCLES,
+	SC2D_STAT_RECTS,
+	SC2D_STAT_CIRCLE_CENTERED_RECT,
+	SC2D_STAT_CIRCLE_RECT,
+	SC2D_STAT_TEST_POINT_CIRCLE,
+	SC2D_STAT_TEST_CIRCLES,
+	SC2D_STAT_TEST_CIRCLE_CENTERED_RECT,
+	SC2D_STAT_TEST_CIRCLE_RECT,
+	SC2D_STAT_TEST_CIRCLE_POLY2D,
+	SC2D_STAT_POLY2D,				// sc2d_check_poly2d and its _cached, _strided and _bounded versions
+	SC2D_STAT_CIRCLE_POLY2D,		// Also sc2d_check_circle_poly2d_strided
+	SC2D_STAT_POINT_POLY2D,			// Also sc2d_check_point_poly2d_strided and sc2d_check_point_poly2d_bounded
+	SC2D_STAT_POINT_LINE,
+	SC2D_STAT_POLYS,				// sc2d_check_polys and sc2d_check_polys_cached
+	SC2D_STAT_POINT_POLY,
+	SC2D_STAT_CIRCLE_POLY,
+	SC2D_STAT_TEST_CIRCLE_POLY,
+	SC2D_STAT_GJK,
+	SC2D_STAT_SHAPES,
+	SC2D_STAT_COLLIDE,
+	SC2D_STAT_POLY2D_TRANSFORMED,
+	SC2D_STAT_POLYS_TRANSFORMED,
+	SC2D_STAT_CIRCLE_POLY2D_TRANSFORMED,
+	SC2D_STAT_MANIFOLD_POLY2D,		// Also sc2d_manifold_polys
+	SC2D_STAT_MANIFOLD_CIRCLE_POLY2D,	// Also sc2d_manifold_circle_poly
+	SC2D_STAT_RECT_TILEMAP,
+	SC2D_STAT_CIRCLE_TILEMAP,
+	SC2D_STAT_FUNCTION_COUNT
+};
+
+const char* sc2d_stats_name(int function);
+
+// Optional per-thread counters, enabled by defining SIMPLE_COLLISION_2D_STATS
+// Without it the counting compiles to nothing, so instrumented builds and production builds run the same code.
+#ifdef SIMPLE_COLLISION_2D_STATS
+
+typedef struct sc2d_stats {
+	unsigned long long calls[SC2D_STAT_FUNCTION_COUNT];
+	unsigned long long hits[SC2D_STAT_FUNCTION_COUNT];		// Misses are calls - hits
+	unsigned long long sat_axes;			// Separating axes tested by the poly2d and polys checks, up to the early out
+	unsigned long long projected_verts;		// Vertices projected onto those axes
+} sc2d_stats;
+
+void sc2d_stats_snapshot(sc2d_stats* stats);
+void sc2d_stats_reset(void);
+
+#endif
+
+// Trace file: an sc2d_trace_header, then one sc2d_trace_record per call, in native byte order
+#define SC2D_TRACE_VERSION 1
+
+typedef struct sc2d_trace_header {
+	char magic[8];				// "sc2dtrc"
+	int version;				// SC2D_TRACE_VERSION
+	int function_count;			// SC2D_STAT_FUNCTION_COUNT of the recording build
+} sc2d_trace_header;
+
+enum {
+	SC2D_TRACE_HIT = 1,
+	SC2D_TRACE_OVERLAP = 2		// The call returned an overlap
+};
+
+// Followed by arg_count floats of arguments, overlap x and y with SC2D_TRACE_OVERLAP (zero on a miss), then
+// poly_count polygons: an sc2d_trace_poly and its count x/y pairs
+typedef struct sc2d_trace_record {
+	unsigned char function;		// SC2D_STAT_*
+	unsigned char flags;		// SC2D_TRACE_*
+	unsigned char arg_count;
+	unsigned char poly_count;
+	int size;					// Bytes, this header included
+} sc2d_trace_record;
+
+typedef struct sc2d_trace_poly {
+	int count;
+	int hull;					// sc2d_poly built with sc2d_poly_make_hull
+} sc2d_trace_poly;
+
+// Optional recording of the calls to the sc2d_check_* and sc2d_test_* functions, enabled by defining SIMPLE_COLLISION_2D_TRACE
+// Not recorded: GJK, sc2d_collide, transformed, manifold and tilemap calls (the checks sc2d_collide makes are).
+#ifdef SIMPLE_COLLISION_2D_TRACE
+
+bool sc2d_trace_start(const char* path, void* memory, size_t size);
+unsigned long long sc2d_trace_stop(void);
+
+#endif
+
+// Optional thread pool for the narrowphase, enabled by defining SIMPLE_COLLISION_2D_THREADS (pthreads or Win32 threads)
+#ifdef SIMPLE_COLLISION_2D_THREADS
+
+#ifndef SC2D_MAX_THREADS
+#define SC2D_MAX_THREADS 64
+#endif
+
+// Pair lists are split into at most this many chunks. The chunk size only depends on the pair count,
+// so the results are the same for any number of threads.
+#ifndef SC2D_MAX_CHUNKS
+#define SC2D_MAX_CHUNKS 1024
+#endif
+
+// Chunk range of one worker. Owners and thieves both take chunks from next, padded to its own cache line.
+typedef struct sc2d_pool_range {
+	volatile long next;
+	long end;
+	char padding[64 - 2 * sizeof(long)];
+} sc2d_pool_range;
+
+// Start parameter of a worker thread
+typedef struct sc2d_pool_worker {
+	struct sc2d_pool* pool;
+	int index;
+} sc2d_pool_worker;
+
+typedef struct sc2d_pool {
+	int thread_count;			// Including the thread that calls sc2d_collide_pairs_parallel
+	int generation;				// Incremented for every job, workers wait for it to change
+	int pending;				// Workers still running the current job
+	bool stop;
+
+	// Current job
+	sc2d_shape* shapes;
+	sc2d_pair* pairs;
+	sc2d_hit* hits;
+	int pair_count, chunk_size, chunk_count;
+	int chunk_hits[SC2D_MAX_CHUNKS];
+	sc2d_pool_range ranges[SC2D_MAX_THREADS];
+	sc2d_pool_worker workers[SC2D_MAX_THREADS];
+
+#ifdef _WIN32
+	HANDLE threads[SC2D_MAX_THREADS];
+	CRITICAL_SECTION mutex, submit;
+	CONDITION_VARIABLE start, done;
+#else
+	pthread_t threads[SC2D_MAX_THREADS];
+	pthread_mutex_t mutex, submit;
+	pthread_cond_t start, done;
+#endif
+} sc2d_pool;
+
+bool sc2d_pool_init(sc2d_pool* pool, int thread_count);
+void sc2d_pool_destroy(sc2d_pool* pool);
+int sc2d_collide_pairs_parallel(sc2d_pool* pool, sc2d_shape* shapes, sc2d_pair* pairs, int pair_count, sc2d_hit* hits);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
 #ifdef SIMPLE_COLLISION_2D_IMPLEMENTATION
@@ -43,32 +567,585 @@ bool sc2d_check_point_line(float px, float py, float start_x, float start_y, flo
 #define sc2d_max fmaxf
 #endif
 
-#ifndef sc2d_atan2
+#ifndef sc2d_floorf
+#include "math.h"
+#define sc2d_floorf floorf
+#endif
+
+#ifndef sc2d_sqrtf
 #include "math.h"
-#define sc2d_atan2 atan2
+#define sc2d_sqrtf sqrtf
+#endif
+
+// SIMD kernels are selected from the compiler's target flags (e.g. -mavx2) and can be disabled by defining
+// SIMPLE_COLLISION_2D_NO_SIMD. Every batch function has a scalar fallback.
+//
+// sc2d_vf is a vector of SC2D_LANES floats and sc2d_vm is the matching comparison mask.
+// SC2D_VF_GATHER(p, pairs, a) loads p[pairs[lane].a] into each lane (with a hardware gather on AVX2).
+#ifndef SIMPLE_COLLISION_2D_NO_SIMD
+	#if defined(__AVX512F__)
+		#include <immintrin.h>
+		#define SC2D_AVX512
+		#define SC2D_LANES 16
+		typedef __m512 sc2d_vf;
+		typedef __mmask16 sc2d_vm;
+		#define SC2D_VF_LOAD(p)				_mm512_loadu_ps(p)
+		#define SC2D_VF_STORE(p, v)			_mm512_storeu_ps(p, v)
+		#define SC2D_VF_SET1(x)				_mm512_set1_ps(x)
+		#define SC2D_VF_ADD(a, b)			_mm512_add_ps(a, b)
+		#define SC2D_VF_SUB(a, b)			_mm512_sub_ps(a, b)
+		#define SC2D_VF_MUL(a, b)			_mm512_mul_ps(a, b)
+		#define SC2D_VF_DIV(a, b)			_mm512_div_ps(a, b)
+		#define SC2D_VF_SQRT(a)				_mm512_sqrt_ps(a)
+		#define SC2D_VF_ABS(a)				_mm512_abs_ps(a)
+		#define SC2D_VF_SELECT(m, a, b)		_mm512_mask_blend_ps(m, b, a)
+		#define SC2D_VM_LT(a, b)			_mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
+		#define SC2D_VM_EQ(a, b)			_mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ)
+		#define SC2D_VM_AND(a, b)			((sc2d_vm)((a) & (b)))
+		#define SC2D_VM_BITS(m)				((int)(m))
+		#define SC2D_VF_GATHER(p, pairs, field) _mm512_set_ps( \
+			(p)[(pairs)[15].field], (p)[(pairs)[14].field], (p)[(pairs)[13].field], (p)[(pairs)[12].field], \
+			(p)[(pairs)[11].field], (p)[(pairs)[10].field], (p)[(pairs)[9].field], (p)[(pairs)[8].field], \
+			(p)[(pairs)[7].field], (p)[(pairs)[6].field], (p)[(pairs)[5].field], (p)[(pairs)[4].field], \
+			(p)[(pairs)[3].field], (p)[(pairs)[2].field], (p)[(pairs)[1].field], (p)[(pairs)[0].field])
+	#elif defined(__AVX2__)
+		#include <immintrin.h>
+		#define SC2D_AVX
+		#define SC2D_LANES 8
+		typedef __m256 sc2d_vf;
+		typedef __m256 sc2d_vm;
+		#define SC2D_VF_LOAD(p)				_mm256_loadu_ps(p)
+		#define SC2D_VF_STORE(p, v)			_mm256_storeu_ps(p, v)
+		#define SC2D_VF_SET1(x)				_mm256_set1_ps(x)
+		#define SC2D_VF_ADD(a, b)			_mm256_add_ps(a, b)
+		#define SC2D_VF_SUB(a, b)			_mm256_sub_ps(a, b)
+		#define SC2D_VF_MUL(a, b)			_mm256_mul_ps(a, b)
+		#define SC2D_VF_DIV(a, b)			_mm256_div_ps(a, b)
+		#define SC2D_VF_SQRT(a)				_mm256_sqrt_ps(a)
+		#define SC2D_VF_ABS(a)				_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a)
+		#define SC2D_VF_SELECT(m, a, b)		_mm256_blendv_ps(b, a, m)
+		#define SC2D_VM_LT(a, b)			_mm256_cmp_ps(a, b, _CMP_LT_OQ)
+		#define SC2D_VM_EQ(a, b)			_mm256_cmp_ps(a, b, _CMP_EQ_OQ)
+		#define SC2D_VM_AND(a, b)			_mm256_and_ps(a, b)
+		#define SC2D_VM_BITS(m)				_mm256_movemask_ps(m)
+		#define SC2D_VF_GATHER(p, pairs, field) _mm256_i32gather_ps(p, avx_pair_index(pairs, offsetof(sc2d_pair, field) != 0), 4)
+
+		// Indices of one side of 8 pairs: load the a/b ints of the pairs and keep every other one
+		static inline __m256i avx_pair_index(const sc2d_pair* pairs, int second) {
+			__m256i order = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+			__m256i lo = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)pairs), order);
+			__m256i hi = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(pairs + 4)), order);
+			return second ? _mm256_permute2x128_si256(lo, hi, 0x31) : _mm256_permute2x128_si256(lo, hi, 0x20);
+		}
+	#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		#include <emmintrin.h>
+		#define SC2D_SSE
+		#define SC2D_LANES 4
+		typedef __m128 sc2d_vf;
+		typedef __m128 sc2d_vm;
+		#define SC2D_VF_LOAD(p)				_mm_loadu_ps(p)
+		#define SC2D_VF_STORE(p, v)			_mm_storeu_ps(p, v)
+		#define SC2D_VF_SET1(x)				_mm_set1_ps(x)
+		#define SC2D_VF_ADD(a, b)			_mm_add_ps(a, b)
+		#define SC2D_VF_SUB(a, b)			_mm_sub_ps(a, b)
+		#define SC2D_VF_MUL(a, b)			_mm_mul_ps(a, b)
+		#define SC2D_VF_DIV(a, b)			_mm_div_ps(a, b)
+		#define SC2D_VF_SQRT(a)				_mm_sqrt_ps(a)
+		#define SC2D_VF_ABS(a)				_mm_andnot_ps(_mm_set1_ps(-0.0f), a)
+		#define SC2D_VF_SELECT(m, a, b)		_mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+		#define SC2D_VM_LT(a, b)			_mm_cmplt_ps(a, b)
+		#define SC2D_VM_EQ(a, b)			_mm_cmpeq_ps(a, b)
+		#define SC2D_VM_AND(a, b)			_mm_and_ps(a, b)
+		#define SC2D_VM_BITS(m)				_mm_movemask_ps(m)
+		#define SC2D_VF_GATHER(p, pairs, field) _mm_set_ps( \
+			(p)[(pairs)[3].field], (p)[(pairs)[2].field], (p)[(pairs)[1].field], (p)[(pairs)[0].field])
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#include <arm_neon.h>
+		#define SC2D_NEON
+		#define SC2D_LANES 4
+		typedef float32x4_t sc2d_vf;
+		typedef uint32x4_t sc2d_vm;
+		#define SC2D_VF_LOAD(p)				vld1q_f32(p)
+		#define SC2D_VF_STORE(p, v)			vst1q_f32(p, v)
+		#define SC2D_VF_SET1(x)				vdupq_n_f32(x)
+		#define SC2D_VF_ADD(a, b)			vaddq_f32(a, b)
+		#define SC2D_VF_SUB(a, b)			vsubq_f32(a, b)
+		#define SC2D_VF_MUL(a, b)			vmulq_f32(a, b)
+	#if defined(__aarch64__)
+		#define SC2D_VF_DIV(a, b)			vdivq_f32(a, b)
+		#define SC2D_VF_SQRT(a)				vsqrtq_f32(a)
+	#else
+		#define SC2D_VF_DIV(a, b)			neon_div(a, b)
+		#define SC2D_VF_SQRT(a)				neon_sqrt(a)
+	#endif
+		#define SC2D_VF_ABS(a)				vabsq_f32(a)
+		#define SC2D_VF_SELECT(m, a, b)		vbslq_f32(m, a, b)
+		#define SC2D_VM_LT(a, b)			vcltq_f32(a, b)
+		#define SC2D_VM_EQ(a, b)			vceqq_f32(a, b)
+		#define SC2D_VM_AND(a, b)			vandq_u32(a, b)
+		#define SC2D_VM_BITS(m)				neon_movemask(m)
+		#define SC2D_VF_GATHER(p, pairs, field) neon_set4( \
+			(p)[(pairs)[0].field], (p)[(pairs)[1].field], (p)[(pairs)[2].field], (p)[(pairs)[3].field])
+
+		static inline float32x4_t neon_set4(float a, float b, float c, float d) {
+			float lanes[4] = {a, b, c, d};
+			return vld1q_f32(lanes);
+		}
+
+		// 32-bit NEON has no divide or square root, so these go lane by lane
+		static inline float32x4_t neon_div(float32x4_t a, float32x4_t b) {
+			float x[4], y[4];
+			vst1q_f32(x, a);
+			vst1q_f32(y, b);
+			for (int i = 0; i < 4; i++) x[i] /= y[i];
+			return vld1q_f32(x);
+		}
+
+		static inline float32x4_t neon_sqrt(float32x4_t a) {
+			float x[4];
+			vst1q_f32(x, a);
+			for (int i = 0; i < 4; i++) x[i] = sc2d_sqrtf(x[i]);
+			return vld1q_f32(x);
+		}
+
+		static inline int neon_movemask(uint32x4_t m) {
+			static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+			uint32x4_t bits = vandq_u32(m, vld1q_u32(lane_bits));
+			uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+			return (int)vget_lane_u32(vpadd_u32(sum, sum), 0);
+		}
+	#endif
+#endif
+
+#ifndef SC2D_LANES
+#define SC2D_LANES 1
+#endif
+
+#if defined(SIMPLE_COLLISION_2D_STATS) || defined(SIMPLE_COLLISION_2D_TRACE)
+#if defined(__cplusplus) && __cplusplus >= 201103L
+	#define SC2D_THREAD_LOCAL thread_local
+#elif defined(_MSC_VER)
+	#define SC2D_THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+	#define SC2D_THREAD_LOCAL _Thread_local
+#else
+	#define SC2D_THREAD_LOCAL __thread
+#endif
+#endif
+
+#if defined(SIMPLE_COLLISION_2D_THREADS) || defined(SIMPLE_COLLISION_2D_TRACE)
+#ifdef _WIN32
+#define sc2d_atomic_fetch_add(pointer, value) InterlockedExchangeAdd((pointer), (value))
+#define pool_lock(lock) EnterCriticalSection(lock)
+#define pool_unlock(lock) LeaveCriticalSection(lock)
+#define pool_wait(cond, lock) SleepConditionVariableCS((cond), (lock), INFINITE)
+#define pool_signal(cond) WakeConditionVariable(cond)
+#define pool_broadcast(cond) WakeAllConditionVariable(cond)
+#else
+#define sc2d_atomic_fetch_add(pointer, value) __atomic_fetch_add((pointer), (value), __ATOMIC_RELAXED)
+#define pool_lock(lock) pthread_mutex_lock(lock)
+#define pool_unlock(lock) pthread_mutex_unlock(lock)
+#define pool_wait(cond, lock) pthread_cond_wait((cond), (lock))
+#define pool_signal(cond) pthread_cond_signal(cond)
+#define pool_broadcast(cond) pthread_cond_broadcast(cond)
+#endif
+#endif
+
+// Name of a counted or recorded function (SC2D_STAT_*), for reports
+const char* sc2d_stats_name(int function) {
+	static const char* names[SC2D_STAT_FUNCTION_COUNT] = {
+		"sc2d_check_point_circle", "sc2d_check_point_rect", "sc2d_check_circles", "sc2d_check_rects",
+		"sc2d_check_circle_centered_rect", "sc2d_check_circle_rect",
+		"sc2d_test_point_circle", "sc2d_test_circles", "sc2d_test_circle_centered_rect", "sc2d_test_circle_rect",
+		"sc2d_test_circle_poly2d",
+		"sc2d_check_poly2d", "sc2d_check_circle_poly2d", "sc2d_check_point_poly2d", "sc2d_check_point_line",
+		"sc2d_check_polys", "sc2d_check_point_poly", "sc2d_check_circle_poly", "sc2d_test_circle_poly",
+		"sc2d_check_gjk", "sc2d_check_shapes", "sc2d_collide",
+		"sc2d_check_poly2d_transformed", "sc2d_check_polys_transformed", "sc2d_check_circle_poly2d_transformed",
+		"sc2d_manifold_poly2d", "sc2d_manifold_circle_poly2d",
+		"sc2d_check_rect_tilemap", "sc2d_check_circle_tilemap"
+	};
+
+	return (function >= 0 && function < SC2D_STAT_FUNCTION_COUNT) ? names[function] : "unknown";
+}
+
+// Trace recording: SC2D_TRACE_BEGIN* starts a record with the arguments of a check, and the SC2D_COUNT_CALL that returns
+// from the same check finishes it with the result. Each thread appends to its own block of the caller's memory, and
+// a writer thread writes full blocks to the file, so checks never wait for the disk.
+#ifdef SIMPLE_COLLISION_2D_TRACE
+
+#include <stdio.h>
+
+// Bytes per block. Records never span blocks, so a record that doesn't fit in one is dropped.
+#ifndef SC2D_TRACE_BLOCK_SIZE
+#define SC2D_TRACE_BLOCK_SIZE 65536
+#endif
+
+typedef struct trace_block {
+	struct trace_block* next;
+	int used;				// Bytes of records after this header
+	int records;
+	bool held;				// A thread is appending to it
+} trace_block;
+
+#define TRACE_BLOCK_CAPACITY ((int)(SC2D_TRACE_BLOCK_SIZE - sizeof(trace_block)))
+
+static struct {
+	bool active;				// Only changed while no check runs, see sc2d_trace_start
+	bool stop;
+	unsigned session;			// Changes with every start and stop, so threads let go of blocks from an earlier trace
+	FILE* file;
+	char* memory;
+	int block_count;
+	trace_block* free_blocks;
+	trace_block* full_first;	// Queue of blocks for the writer
+	trace_block* full_last;
+	unsigned long long dropped;
+
+#ifdef _WIN32
+	HANDLE writer;
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE full;
+#else
+	pthread_t writer;
+	pthread_mutex_t mutex;
+	pthread_cond_t full;
+#endif
+} trace_state;
+
+typedef struct trace_thread {
+	trace_block* block;
+	unsigned session;
+	sc2d_trace_record* record;	// Started, not finished yet
+	sc2d_trace_record dropped;	// Stands in for a record that didn't fit, so the checks it makes aren't recorded either
+	float* overlap_x;
+	float* overlap_y;
+} trace_thread;
+
+static SC2D_THREAD_LOCAL trace_thread thread_trace;
+
+static const sc2d_verts trace_no_verts = {0, 0, 0, 0, 0};
+
+static inline sc2d_verts v2_view(float* verts, int count);
+static inline sc2d_verts packed_view(float* verts, int count);
+static inline float vert_x(sc2d_verts* verts, int i);
+static inline float vert_y(sc2d_verts* verts, int i);
+
+// Hand a block to the writer, with the lock held
+static void trace_queue(trace_block* block) {
+	block->held = false;
+	block->next = 0;
+	if (trace_state.full_last) trace_state.full_last->next = block;
+	else trace_state.full_first = block;
+	trace_state.full_last = block;
+	pool_signal(&trace_state.full);
+}
+
+// Room for size bytes in the calling thread's block, or NULL if the record has to be dropped
+static char* trace_reserve(int size) {
+	trace_thread* thread = &thread_trace;
+	trace_block* block;
+
+	if (thread->session != trace_state.session) {
+		thread->block = 0;
+		thread->session = trace_state.session;
+	}
+
+	block = thread->block;
+	if (!block || block->used + size > TRACE_BLOCK_CAPACITY) {
+		pool_lock(&trace_state.mutex);
+		if (block) trace_queue(block);
+
+		// Rather than waiting for the writer, drop records while every block is full
+		block = thread->block = trace_state.free_blocks;
+		if (block) {
+			trace_state.free_blocks = block->next;
+			block->used = 0;
+			block->records = 0;
+			block->held = true;
+		}
+		if (!block || size > TRACE_BLOCK_CAPACITY) trace_state.dropped++;
+		pool_unlock(&trace_state.mutex);
+
+		if (!block || size > TRACE_BLOCK_CAPACITY) return 0;
+	}
+
+	char* data = (char*)(block + 1) + block->used;
+	block->used += size;
+	block->records++;
+	return data;
+}
+
+static void trace_begin(int function, const float* args, int arg_count, int poly_count, sc2d_verts p1, sc2d_verts p2, int hulls,
+						float* overlap_x, float* overlap_y) {
+	trace_thread* thread = &thread_trace;
+	sc2d_verts* polys[2] = {&p1, &p2};
+
+	// Checks built on other checks: only the outer call is recorded
+	if (thread->record) return;
+
+	int value_count = arg_count + (overlap_x ? 2 : 0);
+	int size = (int)(sizeof(sc2d_trace_record) + value_count * sizeof(float));
+	for (int i = 0; i < poly_count; i++) size += (int)(sizeof(sc2d_trace_poly) + polys[i]->count * 2 * sizeof(float));
+
+	char* data = trace_reserve(size);
+	if (!data) {
+		thread->dropped.function = (unsigned char)function;
+		thread->dropped.flags = 0;
+		thread->record = &thread->dropped;
+		return;
+	}
+
+	sc2d_trace_record* record = (sc2d_trace_record*)data;
+	record->function = (unsigned char)function;
+	record->flags = overlap_x ? SC2D_TRACE_OVERLAP : 0;
+	record->arg_count = (unsigned char)arg_count;
+	record->poly_count = (unsigned char)poly_count;
+	record->size = size;
+
+	float* values = (float*)(record + 1);
+	for (int i = 0; i < arg_count; i++) values[i] = args[i];
+	for (int i = arg_count; i < value_count; i++) values[i] = 0;
+
+	data = (char*)(values + value_count);
+	for (int i = 0; i < poly_count; i++) {
+		sc2d_trace_poly* poly = (sc2d_trace_poly*)data;
+		float* verts = (float*)(poly + 1);
+
+		poly->count = polys[i]->count;
+		poly->hull = (hulls >> i) & 1;
+		for (int j = 0; j < poly->count; j++) {
+			verts[j * 2] = vert_x(polys[i], j);
+			verts[j * 2 + 1] = vert_y(polys[i], j);
+		}
+		data = (char*)(verts + poly->count * 2);
+	}
+
+	thread->record = record;
+	thread->overlap_x = overlap_x;
+	thread->overlap_y = overlap_y;
+}
+
+// Finish the record of the calling thread with the result, if it was started by the same function
+static inline bool trace_end(int function, bool hit) {
+	if (!trace_state.active) return hit; // Records are only pending while recording, see sc2d_trace_start
+
+	trace_thread* thread = &thread_trace;
+	sc2d_trace_record* record = thread->record;
+
+	if (record && record->function == function) {
+		if (hit) {
+			record->flags |= SC2D_TRACE_HIT;
+
+			if (record->flags & SC2D_TRACE_OVERLAP) {
+				float* overlap = (float*)(record + 1) + record->arg_count;
+				overlap[0] = *thread->overlap_x;
+				overlap[1] = *thread->overlap_y;
+			}
+		}
+		thread->record = 0;
+	}
+	return hit;
+}
+
+#define SC2D_TRACE_RECORD(function, poly_count, p1, p2, hulls, overlap_x, overlap_y, ...) do { \
+		if (trace_state.active) { \
+			const float trace_args[] = {__VA_ARGS__}; \
+			trace_begin((function), trace_args, (int)(sizeof(trace_args) / sizeof(float)), (poly_count), (p1), (p2), (hulls), (overlap_x), (overlap_y)); \
+		} \
+	} while (0)
+
+// Start a record of a check: its overlap pointers (or NULL), then its float arguments
+#define SC2D_TRACE_BEGIN(function, overlap_x, overlap_y, ...) \
+	SC2D_TRACE_RECORD(function, 0, trace_no_verts, trace_no_verts, 0, overlap_x, overlap_y, __VA_ARGS__)
+// Same with the vertices of one or two polygons (sc2d_verts) and whether they are hulls (bit 0 and bit 1)
+#define SC2D_TRACE_BEGIN_POLY(function, poly, hulls, overlap_x, overlap_y, ...) \
+	SC2D_TRACE_RECORD(function, 1, poly, trace_no_verts, hulls, overlap_x, overlap_y, __VA_ARGS__)
+#define SC2D_TRACE_BEGIN_POLYS(function, p1, p2, hulls, overlap_x, overlap_y, ...) \
+	SC2D_TRACE_RECORD(function, 2, p1, p2, hulls, overlap_x, overlap_y, __VA_ARGS__)
+#define SC2D_TRACE_END(function, hit) trace_end((function), (hit))
+
+#ifdef _WIN32
+static DWORD WINAPI trace_writer(LPVOID parameter) {
+#else
+static void* trace_writer(void* parameter) {
+#endif
+	(void)parameter;
+
+	for (;;) {
+		pool_lock(&trace_state.mutex);
+		while (!trace_state.full_first && !trace_state.stop) pool_wait(&trace_state.full, &trace_state.mutex);
+
+		trace_block* block = trace_state.full_first;
+		if (block) {
+			trace_state.full_first = block->next;
+			if (!trace_state.full_first) trace_state.full_last = 0;
+		}
+		pool_unlock(&trace_state.mutex);
+
+		if (!block) break; // Stopped, and every block is written
+
+		bool written = fwrite(block + 1, 1, (size_t)block->used, trace_state.file) == (size_t)block->used;
+
+		pool_lock(&trace_state.mutex);
+		if (!written) trace_state.dropped += (unsigned long long)block->records;
+		block->next = trace_state.free_blocks;
+		trace_state.free_blocks = block;
+		pool_unlock(&trace_state.mutex);
+	}
+
+	return 0;
+}
+
+// Start recording calls to a new trace file at path
+// memory: caller-owned, at least two blocks of SC2D_TRACE_BLOCK_SIZE bytes, and aligned like malloc. More blocks ride out
+// longer disk stalls before records are dropped.
+// No check may be running in another thread while the trace starts or stops. Returns false if the file or the writer
+// thread could not be created.
+bool sc2d_trace_start(const char* path, void* memory, size_t size) {
+	sc2d_trace_header header = {"sc2dtrc", SC2D_TRACE_VERSION, SC2D_STAT_FUNCTION_COUNT};
+	int block_count = (int)(size / SC2D_TRACE_BLOCK_SIZE);
+
+	if (trace_state.active || block_count < 2) return false;
+
+	trace_state.file = fopen(path, "wb");
+	if (!trace_state.file) return false;
+	if (fwrite(&header, sizeof(header), 1, trace_state.file) != 1) {
+		fclose(trace_state.file);
+		return false;
+	}
+
+	trace_state.memory = (char*)memory;
+	trace_state.block_count = block_count;
+	trace_state.free_blocks = trace_state.full_first = trace_state.full_last = 0;
+	for (int i = block_count - 1; i >= 0; i--) {
+		trace_block* block = (trace_block*)(trace_state.memory + (size_t)i * SC2D_TRACE_BLOCK_SIZE);
+		block->held = false;
+		block->next = trace_state.free_blocks;
+		trace_state.free_blocks = block;
+	}
+	trace_state.dropped = 0;
+	trace_state.stop = false;
+	trace_state.session++;
+
+#ifdef _WIN32
+	InitializeCriticalSection(&trace_state.mutex);
+	InitializeConditionVariable(&trace_state.full);
+	trace_state.writer = CreateThread(0, 0, trace_writer, 0, 0, 0);
+	if (!trace_state.writer) {
+		DeleteCriticalSection(&trace_state.mutex);
+#else
+	pthread_mutex_init(&trace_state.mutex, 0);
+	pthread_cond_init(&trace_state.full, 0);
+	if (pthread_create(&trace_state.writer, 0, trace_writer, 0) != 0) {
+		pthread_mutex_destroy(&trace_state.mutex);
+		pthread_cond_destroy(&trace_state.full);
+#endif
+		fclose(trace_state.file);
+		return false;
+	}
+
+	trace_state.active = true;
+	return true;
+}
+
+// Write the blocks every thread has filled so far, close the file and return the number of records that were dropped,
+// because every block was waiting for the disk or because the file could not be written
+unsigned long long sc2d_trace_stop(void) {
+	if (!trace_state.active) return 0;
+	trace_state.active = false;
+
+	pool_lock(&trace_state.mutex);
+	for (int i = 0; i < trace_state.block_count; i++) {
+		trace_block* block = (trace_block*)(trace_state.memory + (size_t)i * SC2D_TRACE_BLOCK_SIZE);
+		if (block->held) trace_queue(block);
+	}
+	trace_state.stop = true;
+	pool_signal(&trace_state.full);
+	pool_unlock(&trace_state.mutex);
+
+#ifdef _WIN32
+	WaitForSingleObject(trace_state.writer, INFINITE);
+	CloseHandle(trace_state.writer);
+	DeleteCriticalSection(&trace_state.mutex);
+#else
+	pthread_join(trace_state.writer, 0);
+	pthread_mutex_destroy(&trace_state.mutex);
+	pthread_cond_destroy(&trace_state.full);
+#endif
+
+	if (fclose(trace_state.file) != 0) trace_state.dropped++;
+	trace_state.session++;
+	return trace_state.dropped;
+}
+
+#else
+
+#define SC2D_TRACE_BEGIN(function, overlap_x, overlap_y, ...) ((void)0)
+#define SC2D_TRACE_BEGIN_POLY(function, poly, hulls, overlap_x, overlap_y, ...) ((void)0)
+#define SC2D_TRACE_BEGIN_POLYS(function, p1, p2, hulls, overlap_x, overlap_y, ...) ((void)0)
+#define SC2D_TRACE_END(function, hit) (hit)
+
+#endif
+
+// Statistics counters: SC2D_COUNT_CALL evaluates to hit, so checks can wrap their return values. It also finishes trace records.
+#ifdef SIMPLE_COLLISION_2D_STATS
+
+// Each thread counts into its own copy, so counting needs no atomics
+static SC2D_THREAD_LOCAL sc2d_stats thread_stats;
+
+static inline bool count_call(int function, bool hit) {
+	thread_stats.calls[function]++;
+	thread_stats.hits[function] += hit;
+	return hit;
+}
+
+#define SC2D_COUNT_CALL(function, hit) count_call((function), SC2D_TRACE_END((function), (hit)))
+#define SC2D_COUNT_ADD(counter, value) (thread_stats.counter += (unsigned long long)(value))
+
+// Copy the counters of the calling thread
+void sc2d_stats_snapshot(sc2d_stats* stats) {
+	*stats = thread_stats;
+}
+
+// Zero the counters of the calling thread
+void sc2d_stats_reset(void) {
+	static sc2d_stats zero; // Zero initialized
+	thread_stats = zero;
+}
+
+#else
+
+#define SC2D_COUNT_CALL(function, hit) SC2D_TRACE_END((function), (hit))
+#define SC2D_COUNT_ADD(counter, value) ((void)0)
+
 #endif
 
 // Check for collion between a point and a circle and return penetration by reference
 bool sc2d_check_point_circle(float px, float py, float cx, float cy, float cr, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_POINT_CIRCLE, overlap_x, overlap_y, px, py, cx, cy, cr);
 
 	float delta_x = cx - px;
 	float delta_y = cy - py;
 
-	float delta_m = sc2d_hypotf(delta_x, delta_y);
-	float delta_r =  cr - delta_m;
+	// Decide with squared distances, the square root is only needed on hits
+	if (result = (delta_x * delta_x + delta_y * delta_y) < cr * cr) {
+		float delta_m = sc2d_sqrtf(delta_x * delta_x + delta_y * delta_y);
+		float delta_r = cr - delta_m;
 
-	if (result = delta_r > 0) {
+		if (delta_m == 0.0f) delta_m = 1.0f; // Point at the center: any direction works, avoid dividing by zero
 		*overlap_x = (delta_x / delta_m) * delta_r;
 		*overlap_y = (delta_y / delta_m) * delta_r;
 	}
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_CIRCLE, result);
 }
 
 // Check for collision between a point and a rectangle (left x, top y, width, height) and return penetration by reference
 bool sc2d_check_point_rect(float px, float py, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_POINT_RECT, overlap_x, overlap_y, px, py, rx, ry, rw, rh);
 
 	float rect_center_width = rw/2.0f;
 	float rect_center_height = rh/2.0f;
@@ -90,29 +1167,35 @@ bool sc2d_check_point_rect(float px, float py, float rx, float ry, float rw, flo
 		if (delta_y < 0) *overlap_y *= -1;
 	}
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_RECT, result);
 }
 
 // Check for collion between two circles and return overlap by reference
 bool sc2d_check_circles(float p1x, float p1y, float r1, float p2x, float p2y, float r2, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_CIRCLES, overlap_x, overlap_y, p1x, p1y, r1, p2x, p2y, r2);
 
 	float delta_x = p2x - p1x;
 	float delta_y = p2y - p1y;
-	float magnitude = sc2d_hypotf(delta_x, delta_y);
-	float overlap_magnitude = (r1 + r2) - magnitude;
+	float radius = r1 + r2;
 
-	if (result = overlap_magnitude > 0) {
+	// Decide with squared distances, the square root is only needed on hits
+	if ((result = (delta_x * delta_x + delta_y * delta_y) < radius * radius)) {
+		float magnitude = sc2d_sqrtf(delta_x * delta_x + delta_y * delta_y);
+		float overlap_magnitude = radius - magnitude;
+
+		if (magnitude == 0.0f) magnitude = 1.0f; // Same centers: any direction works, avoid dividing by zero
 		*overlap_x = (delta_x / magnitude) * overlap_magnitude;
 		*overlap_y = (delta_y / magnitude) * overlap_magnitude;
 	}
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLES, result);
 }
 
 //Check for collision between to rectangles (left x, top y, width, height) and return overlap by reference
 bool sc2d_check_rects(float p1x, float p1y, float r1w, float r1h, float p2x, float p2y, float r2w, float r2h, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_RECTS, overlap_x, overlap_y, p1x, p1y, r1w, r1h, p2x, p2y, r2w, r2h);
 
 	if (p1x < p2x) 	*overlap_x = (p1x + r1w) - p2x;
 	else 			*overlap_x = (p2x + r2w) - p1x;
@@ -120,7 +1203,7 @@ bool sc2d_check_rects(float p1x, float p1y, float r1w, float r1h, float p2x, flo
 	if (p1y < p2y) 	*overlap_y = (p1y + r1h) - p2y;
 	else			*overlap_y = (p2y + r2h) - p1y;
 	
-	if ( result = (*overlap_x > 0 && *overlap_y > 0) ) {
+	if ( (result = (*overlap_x > 0 && *overlap_y > 0)) ) {
 		if (p2x < p1x) *overlap_x *= -1;
 		if (p2y < p1y) *overlap_y *= -1;
 
@@ -128,49 +1211,44 @@ bool sc2d_check_rects(float p1x, float p1y, float r1w, float r1h, float p2x, flo
 		*overlap_y *= (float)(int)(*overlap_x == 0);
 	}
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_RECTS, result);
 }
 
 // Check for collision of circle and centered rectangle (center x, center y, width, height) and return overlap by reference
 // TO-DO: Handle containment (circle inside of rect)
 bool sc2d_check_circle_centered_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_CIRCLE_CENTERED_RECT, overlap_x, overlap_y, cx, cy, cr, rx, ry, rw, rh);
+
+	// Reject with squared distances first, the square root is only needed on hits
+	if (!sc2d_test_circle_centered_rect(cx, cy, cr, rx, ry, rw, rh)) return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_CENTERED_RECT, false);
 
 	// Get a vector pointing from center of rect to center of circle
 	float delta_x = cx - rx;
 	float delta_y = cy - ry;
 
-	if ( sc2d_fabsf(delta_x) > (cr + rw) || sc2d_fabsf(delta_y) > (cr + rh)) {
-		result = false;
-	} else {
-		//Get intersection point of vector and nearest rect edge relative to the center of the rectangle
-		float clamp_x = sc2d_min(sc2d_max(delta_x, -rw), rw);
-		float clamp_y = sc2d_min(sc2d_max(delta_y, -rh), rh);
-	
-		// Get a vector pointing from the center of circle to center of rect
-		delta_x = rx - cx;
-		delta_y = ry - cy;
+	//Get intersection point of vector and nearest rect edge relative to the center of the rectangle
+	float clamp_x = (delta_x < -rw) ? -rw : ((delta_x > rw) ? rw : delta_x);
+	float clamp_y = (delta_y < -rh) ? -rh : ((delta_y > rh) ? rh : delta_y);
 
-		// Get vector pointing from circle center to collision point
-		clamp_x += delta_x;
-		clamp_y += delta_y;
+	// Get vector pointing from circle center to collision point
+	clamp_x -= delta_x;
+	clamp_y -= delta_y;
 
-		float magnitude = sc2d_hypotf(clamp_x, clamp_y);
+	float magnitude = sc2d_sqrtf(clamp_x * clamp_x + clamp_y * clamp_y);
 
-		if (magnitude == 0.0f) magnitude = 1.0f; //Hack to avoid divide by zero when circle is inside rect
-		if (magnitude < cr) {
-			*overlap_x = (clamp_x / magnitude) * (cr - magnitude); 
-			*overlap_y = (clamp_y / magnitude) * (cr - magnitude); 
-			result = true;
-		}
-	}
+	if (magnitude == 0.0f) magnitude = 1.0f; //Hack to avoid divide by zero when circle is inside rect
+	*overlap_x = (clamp_x / magnitude) * (cr - magnitude); 
+	*overlap_y = (clamp_y / magnitude) * (cr - magnitude); 
+	result = true;
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_CENTERED_RECT, result);
 }
 
 // Check for collision between circle and rectangle (left x, top y, width, height) and return overlap vector by reference
 bool sc2d_check_circle_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh, float* overlap_x, float* overlap_y) {
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_CIRCLE_RECT, overlap_x, overlap_y, cx, cy, cr, rx, ry, rw, rh);
 
 	rw /= 2.0f;
 	rh /= 2.0f;
@@ -180,21 +1258,87 @@ bool sc2d_check_circle_rect(float cx, float cy, float cr, float rx, float ry, fl
 
 	result = sc2d_check_circle_centered_rect(cx, cy, cr, rx, ry, rw, rh, overlap_x, overlap_y);
 
-	return result;
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_RECT, result);
 }
 
-// Project all points in polygon to 2D vector axis (dot product)
-static inline void project_poly2d_to_axis(float axis_x, float axis_y, float* poly_verts, int poly_vert_count, float* min, float* max) {
-	*min=0; *max=0;
+// Check if a point is inside a circle
+bool sc2d_test_point_circle(float px, float py, float cx, float cy, float cr) {
+	SC2D_TRACE_BEGIN(SC2D_STAT_TEST_POINT_CIRCLE, 0, 0, px, py, cx, cy, cr);
+	float delta_x = cx - px;
+	float delta_y = cy - py;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_POINT_CIRCLE, (delta_x * delta_x + delta_y * delta_y) < cr * cr);
+}
+
+// Check if two circles overlap
+bool sc2d_test_circles(float p1x, float p1y, float r1, float p2x, float p2y, float r2) {
+	SC2D_TRACE_BEGIN(SC2D_STAT_TEST_CIRCLES, 0, 0, p1x, p1y, r1, p2x, p2y, r2);
+	float delta_x = p2x - p1x;
+	float delta_y = p2y - p1y;
+	float radius = r1 + r2;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLES, (delta_x * delta_x + delta_y * delta_y) < radius * radius);
+}
+
+// Check if a circle overlaps a centered rectangle (center x, center y, half width, half height)
+bool sc2d_test_circle_centered_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh) {
+	SC2D_TRACE_BEGIN(SC2D_STAT_TEST_CIRCLE_CENTERED_RECT, 0, 0, cx, cy, cr, rx, ry, rw, rh);
+	// Distance from the circle center to the rect on each axis (0 inside the rect's extent)
+	float delta_x = sc2d_fabsf(cx - rx) - rw;
+	float delta_y = sc2d_fabsf(cy - ry) - rh;
+
+	delta_x = (delta_x > 0) ? delta_x : 0;
+	delta_y = (delta_y > 0) ? delta_y : 0;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLE_CENTERED_RECT, (delta_x * delta_x + delta_y * delta_y) < cr * cr);
+}
+
+// Check if a circle overlaps a rectangle (left x, top y, width, height)
+bool sc2d_test_circle_rect(float cx, float cy, float cr, float rx, float ry, float rw, float rh) {
+	SC2D_TRACE_BEGIN(SC2D_STAT_TEST_CIRCLE_RECT, 0, 0, cx, cy, cr, rx, ry, rw, rh);
+	rw /= 2.0f;
+	rh /= 2.0f;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLE_RECT, sc2d_test_circle_centered_rect(cx, cy, cr, rx + rw, ry + rh, rw, rh));
+}
 
+// Vertex view of x/y pairs, or of sc2d_v2 structs when SIMPLE_COLLISION_2D_VECTOR2 is set
+static inline sc2d_verts v2_view(float* verts, int count) {
 #ifndef SIMPLE_COLLISION_2D_VECTOR2
 	typedef struct sc2d_v2 {float x, y;} sc2d_v2;
 #endif
+	sc2d_verts view = {verts, (int)sizeof(sc2d_v2), (int)offsetof(sc2d_v2, x), (int)offsetof(sc2d_v2, y), count};
+	return view;
+}
+
+// Vertex view of packed x/y pairs, like the vertices of an sc2d_poly
+static inline sc2d_verts packed_view(float* verts, int count) {
+	sc2d_verts view = {verts, (int)(2 * sizeof(float)), 0, (int)sizeof(float), count};
+	return view;
+}
+
+static inline float vert_x(sc2d_verts* verts, int i) {
+	return *(float*)((char*)verts->base + (ptrdiff_t)i * verts->stride + verts->offset_x);
+}
+
+static inline float vert_y(sc2d_verts* verts, int i) {
+	return *(float*)((char*)verts->base + (ptrdiff_t)i * verts->stride + verts->offset_y);
+}
 
-	sc2d_v2* v2_verts = (sc2d_v2*)poly_verts;
+// Bounding circle reject: true if shapes whose bounding circles have the given combined radius are apart
+// Touching circles are kept, like touching projections in the separating axis tests.
+static inline bool bounds_apart(float delta_x, float delta_y, float radius) {
+	return delta_x * delta_x + delta_y * delta_y > radius * radius;
+}
+
+// Project all points in polygon to 2D vector axis (dot product)
+static inline void project_poly2d_to_axis(float axis_x, float axis_y, sc2d_verts* verts, float* min, float* max) {
+	*min=0; *max=0;
+
+	SC2D_COUNT_ADD(projected_verts, verts->count);
 	
-	for (int i = 0; i < poly_vert_count; i++) {
-		float dot = (axis_x * v2_verts[i].x) + (axis_y * v2_verts[i].y); // dot product
+	for (int i = 0; i < verts->count; i++) {
+		float dot = (axis_x * vert_x(verts, i)) + (axis_y * vert_y(verts, i)); // dot product
 		*min = sc2d_min(*min, dot);
 		*max = sc2d_max(*max, dot);
 	}
@@ -202,15 +1346,11 @@ static inline void project_poly2d_to_axis(float axis_x, float axis_y, float* pol
 
 // Get vector from start index to next vertex in polygon
 
-static inline void get_poly2d_edge(float* poly_verts, int vert_count, int start_index, float* edge_x, float* edge_y) {
-#ifndef SIMPLE_COLLISION_2D_VECTOR2
-	typedef struct sc2d_v2 {float x, y;} sc2d_v2;
-#endif
-	sc2d_v2* v2_verts = (sc2d_v2*)poly_verts;
-	int end_index = (start_index + 1) % vert_count; // wrap to first vertex
+static inline void get_poly2d_edge(sc2d_verts* verts, int start_index, float* edge_x, float* edge_y) {
+	int end_index = (start_index + 1) % verts->count; // wrap to first vertex
 
-	*edge_x = v2_verts[end_index].x - v2_verts[start_index].x;
-	*edge_y = v2_verts[end_index].y - v2_verts[start_index].y;
+	*edge_x = vert_x(verts, end_index) - vert_x(verts, start_index);
+	*edge_y = vert_y(verts, end_index) - vert_y(verts, start_index);
 }
 
 // Get clockwise or counterclockwise normal of 2D vector
@@ -231,6 +1371,79 @@ static void v2_normalize(float* x, float* y) {
 	*y /= magnitude;
 }
 
+// Project both polygons to the normal of one edge (the axis)
+// Returns false if the projections do not overlap (the axis separates the polygons).
+// Otherwise returns the overlap distance and the unit axis pointing from the first polygon toward the second.
+static bool poly2d_axis_overlap(sc2d_verts* axis_verts, int edge, sc2d_verts* p1, sc2d_verts* p2,
+								float delta_x, float delta_y, float* distance, float* axis_x, float* axis_y) {
+	float p1_min, p1_max, p2_min, p2_max;
+	SC2D_COUNT_ADD(sat_axes, 1);
+
+	get_poly2d_edge(axis_verts, edge, axis_x, axis_y); // Get vector pointing from curent vertex to next vertex (edge)
+	v2_normal(axis_x, axis_y, false); // Get the normal of the edge (vector perpendicular to the edge)
+	v2_normalize(axis_x, axis_y);
+	float offset = (*axis_x * delta_x) + (*axis_y * delta_y); // project the the vector between polygon positions to the axis (dot product)
+
+	project_poly2d_to_axis(*axis_x, *axis_y, p1, &p1_min, &p1_max); // project ever y vertex in first polygon to current axis
+	project_poly2d_to_axis(*axis_x, *axis_y, p2, &p2_min, &p2_max); // project ever y vertex in scond polygon to current axis
+
+	p1_min -= offset; // Add position offset to projection
+	p1_max -= offset;
+
+	if ( (p1_min > p2_max) || (p1_max < p2_min)) { // If the ranges do not overlap, polygons are not touching
+		return false;
+	}
+
+	*distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
+	*axis_x *= (float)(1 - 2 * (int)(offset < 0) );
+	*axis_y *= (float)(1 - 2 * (int)(offset < 0) );
+
+	return true;
+}
+
+// Separating axis test of two vertex views, with an optional cache of the last separating axis
+static bool poly2d_sat(sc2d_verts* p1, sc2d_verts* p2, float delta_x, float delta_y, sc2d_sat_cache* cache, float* overlap_x, float* overlap_y) {
+	float axis_x, axis_y, distance;
+	float min_distance = INFINITY;
+
+	// The cached axis only rejects. The full loop below still picks the same axis as an uncached call.
+	if (cache && cache->poly) {
+		sc2d_verts* axis_verts = (cache->poly == 1) ? p1 : p2;
+		if (cache->edge < axis_verts->count &&
+			!poly2d_axis_overlap(axis_verts, cache->edge, p1, p2, delta_x, delta_y, &distance, &axis_x, &axis_y)) {
+			return false;
+		}
+	}
+
+	// Project all vertices to the axes of the first polygon, then the second
+	for (int poly = 1; poly <= 2; poly++) {
+		sc2d_verts* axis_verts = (poly == 1) ? p1 : p2;
+
+		for (int i = 0; i < axis_verts->count; i++) {
+			if (!poly2d_axis_overlap(axis_verts, i, p1, p2, delta_x, delta_y, &distance, &axis_x, &axis_y)) {
+				if (cache) {
+					cache->poly = (unsigned char)poly;
+					cache->edge = (unsigned short)i;
+				}
+				return false;
+			}
+
+			if (distance < min_distance) { // Update minimum distance for overlap
+				min_distance = distance;
+				*overlap_x = axis_x;
+				*overlap_y = axis_y;
+			}
+		}
+	}
+
+	if (cache) cache->poly = 0;
+
+	*overlap_x *= min_distance;
+	*overlap_y *= min_distance;
+
+	return true;
+}
+
 // Check for collision between two convex polygons and return shortest axis overlap by reference
 // p1_count and p2_count: The number of x/y pairs (or custom sc2d_v2 structs) in poly_verts
 //
@@ -241,90 +1454,63 @@ static void v2_normalize(float* x, float* y) {
 // typedef struct v3 {float x, y, z} sc2d_v2;
 // #define SIMPLE_COLLISION_2D_VECTOR2
 // #endif
+// To read several layouts, or vertices inside larger structs, use sc2d_check_poly2d_strided.
 bool sc2d_check_poly2d(	float p1x, float p1y, float* p1_verts, int p1_count, 
 						float p2x, float p2y, float* p2_verts, int p2_count, 
 						float* overlap_x, float* overlap_y) {
-	
-	bool result = true;
-	float p1_min, p1_max, p2_min, p2_max;
-	float axis_x, axis_y;
-
-	float delta_x = p2x - p1x;
-	float delta_y = p2y - p1y;
-	float offset = 0;
-	float min_distance = INFINITY;
-
-	// First polygon
-	for (int i = 0; i < p1_count; i++) {
-		get_poly2d_edge(p1_verts, p1_count, i, &axis_x, &axis_y); // Get vector pointing from curent vertex to next vertex (edge)
-		v2_normal(&axis_x, &axis_y, false); // Get the normal of the edge (vector perpendicular to the edge)
-		v2_normalize(&axis_x, &axis_y);
-		offset = (axis_x * delta_x) + (axis_y * delta_y); // project the the vector between polygon positions to the axis (dot product)
+	return sc2d_check_poly2d_cached(p1x, p1y, p1_verts, p1_count, p2x, p2y, p2_verts, p2_count, 0, overlap_x, overlap_y);
+}
 
-		project_poly2d_to_axis(axis_x, axis_y, p1_verts, p1_count, &p1_min, &p1_max); // project ever y vertex in first polygon to current axis
-		project_poly2d_to_axis(axis_x, axis_y, p2_verts, p2_count, &p2_min, &p2_max); // project ever y vertex in scond polygon to current axis
-		
-		p1_min -= offset; // Add position offset to projection
-		p1_max -= offset;
-		
-		if ( (p1_min > p2_max) || (p1_max < p2_min)) { // If the ranges do not overlap, polygons are not touching
-			return false;
-		}
-		
-		float distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
-		if (distance < min_distance) { // Update minimum distance for overlap
-			min_distance = distance;
-			*overlap_x = axis_x * (float)(1 - 2 * (int)(offset < 0) );
-			*overlap_y = axis_y * (float)(1 - 2 * (int)(offset < 0) );
-		}
-	}
+// Same as sc2d_check_poly2d, but first tests the axis that separated the polygons on the previous call
+// cache: caller-owned and zero initialized, one per polygon pair (or NULL)
+// Pairs that stay separated along the same axis are rejected after projecting to a single axis.
+bool sc2d_check_poly2d_cached(	float p1x, float p1y, float* p1_verts, int p1_count, 
+								float p2x, float p2y, float* p2_verts, int p2_count, 
+								sc2d_sat_cache* cache, float* overlap_x, float* overlap_y) {
+	sc2d_verts p1 = v2_view(p1_verts, p1_count);
+	sc2d_verts p2 = v2_view(p2_verts, p2_count);
 
-	// Project all vertices to all axes of the second polygon
-	for (int i = 0; i < p2_count; i++) {
-		get_poly2d_edge(p2_verts, p2_count, i, &axis_x, &axis_y);
-		v2_normal(&axis_x, &axis_y, false);
-		v2_normalize(&axis_x, &axis_y);
-		offset = (axis_x * delta_x) + (axis_y * delta_y);
+	SC2D_TRACE_BEGIN_POLYS(SC2D_STAT_POLY2D, p1, p2, 0, overlap_x, overlap_y, p1x, p1y, p2x, p2y);
+	return SC2D_COUNT_CALL(SC2D_STAT_POLY2D, poly2d_sat(&p1, &p2, p2x - p1x, p2y - p1y, cache, overlap_x, overlap_y));
+}
 
-		project_poly2d_to_axis(axis_x, axis_y, p1_verts, p1_count, &p1_min, &p1_max);
-		project_poly2d_to_axis(axis_x, axis_y, p2_verts, p2_count, &p2_min, &p2_max);
-		
-		p1_min -= offset;
-		p1_max -= offset;
-		
-		if ( (p1_min > p2_max) || (p1_max < p2_min)) {
-			return false;
-		}
+// Distance from a polygon's position to its farthest vertex, for the bounded checks
+float sc2d_poly2d_radius(float* poly_verts, int vert_count) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	float radius_squared = 0;
 
-		float distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
-		if (distance < min_distance) {
-			min_distance = distance;
-			*overlap_x = axis_x * (float)(1 - 2 * (int)(offset < 0) );
-			*overlap_y = axis_y * (float)(1 - 2 * (int)(offset < 0) );
-		}
+	for (int i = 0; i < vert_count; i++) {
+		float x = vert_x(&verts, i), y = vert_y(&verts, i);
+		radius_squared = sc2d_max(radius_squared, x * x + y * y);
 	}
 
-	*overlap_x *= min_distance;
-	*overlap_y *= min_distance;
+	return sc2d_sqrtf(radius_squared);
+}
 
-	return result;
+// Same as sc2d_check_poly2d, but distant polygons are rejected with one compare of their bounding circles
+bool sc2d_check_poly2d_bounded(	float p1x, float p1y, float* p1_verts, int p1_count, float p1_radius,
+								float p2x, float p2y, float* p2_verts, int p2_count, float p2_radius,
+								float* overlap_x, float* overlap_y) {
+	SC2D_TRACE_BEGIN_POLYS(SC2D_STAT_POLY2D, v2_view(p1_verts, p1_count), v2_view(p2_verts, p2_count), 0, overlap_x, overlap_y, p1x, p1y, p2x, p2y);
+	if (bounds_apart(p2x - p1x, p2y - p1y, p1_radius + p2_radius)) return SC2D_COUNT_CALL(SC2D_STAT_POLY2D, false);
+	return sc2d_check_poly2d_cached(p1x, p1y, p1_verts, p1_count, p2x, p2y, p2_verts, p2_count, 0, overlap_x, overlap_y);
 }
 
-// Check for collision between point and convex polygon
-// poly_count: The number of x/y pairs (or custom sc2d_v2 structs) in poly_verts
-bool sc2d_check_point_poly2d(float px, float py, float* poly_verts, int vert_count) {
+// Same as sc2d_check_poly2d, but reads the vertices in place through strided views (see sc2d_verts)
+bool sc2d_check_poly2d_strided(float p1x, float p1y, sc2d_verts* p1, float p2x, float p2y, sc2d_verts* p2, float* overlap_x, float* overlap_y) {
+	SC2D_TRACE_BEGIN_POLYS(SC2D_STAT_POLY2D, *p1, *p2, 0, overlap_x, overlap_y, p1x, p1y, p2x, p2y);
+	return SC2D_COUNT_CALL(SC2D_STAT_POLY2D, poly2d_sat(p1, p2, p2x - p1x, p2y - p1y, 0, overlap_x, overlap_y));
+}
+
+// Crossing test of a point (relative to the polygon) against a vertex view, also correct for concave polygons
+static bool point_poly2d(float px, float py, sc2d_verts* verts) {
 	bool result = false;
 
-#ifndef SIMPLE_COLLISION_2D_VECTOR2
-	typedef struct sc2d_v2 {float x, y;} sc2d_v2;
-#endif
+	for (int i = 0, j = verts->count - 1; i < verts->count; i++) {
+		float xi = vert_x(verts, i), yi = vert_y(verts, i);
+		float xj = vert_x(verts, j), yj = vert_y(verts, j);
 
-	sc2d_v2* v2_verts = (sc2d_v2*)poly_verts;
-	for (int i = 0, j = vert_count - 1; i < vert_count; i++) {
-		if ( (v2_verts[i].y >= py) != (v2_verts[j].y >= py) &&
-			 (px < (v2_verts[j].x - v2_verts[i].x) * (py - v2_verts[i].y) / (v2_verts[j].y - v2_verts[i].y) + v2_verts[i].x)
-			) {
-			
+		if ( (yi >= py) != (yj >= py) && (px < (xj - xi) * (py - yi) / (yj - yi) + xi) ) {
 			result = !result;
 		}
 
@@ -334,41 +1520,3813 @@ bool sc2d_check_point_poly2d(float px, float py, float* poly_verts, int vert_cou
 	return result;
 }
 
+// Check for collision between point and convex polygon
+// poly_count: The number of x/y pairs (or custom sc2d_v2 structs) in poly_verts
+bool sc2d_check_point_poly2d(float px, float py, float* poly_verts, int vert_count) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_POINT_POLY2D, verts, 0, 0, 0, px, py);
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY2D, point_poly2d(px, py, &verts));
+}
+
+// Same as sc2d_check_point_poly2d, rejecting points outside the polygon's bounding circle first
+bool sc2d_check_point_poly2d_bounded(float px, float py, float* poly_verts, int vert_count, float radius) {
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_POINT_POLY2D, v2_view(poly_verts, vert_count), 0, 0, 0, px, py);
+	if (bounds_apart(px, py, radius)) return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY2D, false);
+	return sc2d_check_point_poly2d(px, py, poly_verts, vert_count);
+}
+
+// Same as sc2d_check_point_poly2d, reading the vertices through a strided view (see sc2d_verts)
+bool sc2d_check_point_poly2d_strided(float px, float py, sc2d_verts* poly) {
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_POINT_POLY2D, *poly, 0, 0, 0, px, py);
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY2D, point_poly2d(px, py, poly));
+}
+
+// Points closer to a line than this fraction of the line's length count as on the line
+#ifndef SC2D_LINE_EPSILON
+#define SC2D_LINE_EPSILON 1e-6f
+#endif
+
 // Check for collision between point and line or line segment
 bool sc2d_check_point_line(float px, float py, float start_x, float start_y, float end_x, float end_y, bool segment) {
-
 	bool result = false;
+	SC2D_TRACE_BEGIN(SC2D_STAT_POINT_LINE, 0, 0, px, py, start_x, start_y, end_x, end_y, segment ? 1.0f : 0.0f);
 
 	// Vector pointing from line start to line end
 	float line_x = end_x - start_x;
 	float line_y = end_y - start_y;
-	float line_length = sc2d_hypotf(line_y, line_x);
+	float length_squared = line_x * line_x + line_y * line_y;
 
 	// Vector point from line start to point
 	float point_delta_x = px - start_x;
 	float point_delta_y = py - start_y;
-	float distance_to_point = sc2d_hypotf(point_delta_x, point_delta_y);
-
-	// If the angles of both vectors are equal,
-	// then the point is on the ray starting at start
-	if (sc2d_atan2(line_y, line_x) == sc2d_atan2(point_delta_y, point_delta_x)) {
-		// if the distance to the point is less than or equal to line length,
-		// then the point is on the segment start -> end
-		if (segment && (distance_to_point <= line_length) ) {
-			result = true;
-		// Else start -> end describes an (infinite) line or a ray
+
+	// The cross product is the line's length times the point's distance from the line, so the point is on the
+	// (infinite) line when it is zero
+	float cross = line_x * point_delta_y - line_y * point_delta_x;
+
+	if (length_squared == 0) {
+		// A line with no length is a single point, and every cross product with it would be zero
+		result = point_delta_x == 0 && point_delta_y == 0;
+	} else if (sc2d_fabsf(cross) <= SC2D_LINE_EPSILON * length_squared) {
+		// On the segment when the projection of the point lies between start and end
+		float dot = line_x * point_delta_x + line_y * point_delta_y;
+		result = !segment || (dot >= 0 && dot <= length_squared);
+	}
+
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_LINE, result);
+}
+
+// Overlap of a circle (center relative to the polygon) and a convex polygon, from the closest point on the boundary
+// Pass NULL overlaps for a boolean-only test. feature (or NULL) receives the closest edge, or the closest vertex as a
+// corner feature id (see SC2D_FEATURE_CORNER).
+// One pass over the edges finds the closest boundary point and whether the center is inside. This gives the same axis
+// as SAT over the edge normals and the closest vertex axis, without projecting the polygon on each of them.
+static bool circle_poly_overlap(float cx, float cy, float cr, sc2d_verts* verts, float* overlap_x, float* overlap_y, unsigned int* feature) {
+	int count = verts->count;
+	float area = 0, min_cross = INFINITY, max_cross = -INFINITY;
+	float closest_distance = INFINITY, closest_x = 0, closest_y = 0, closest_t = 0;
+	int closest_edge = 0;
+
+	for (int i = 0; i < count; i++) {
+		int next = (i + 1 < count) ? i + 1 : 0;
+		float v1_x = vert_x(verts, i), v1_y = vert_y(verts, i);
+		float v2_x = vert_x(verts, next), v2_y = vert_y(verts, next);
+		float edge_x = v2_x - v1_x, edge_y = v2_y - v1_y;
+		float delta_x = cx - v1_x, delta_y = cy - v1_y;
+
+		float cross = edge_x * delta_y - edge_y * delta_x;
+		min_cross = (cross < min_cross) ? cross : min_cross;
+		max_cross = (cross > max_cross) ? cross : max_cross;
+		area += v1_x * v2_y - v2_x * v1_y;
+
+		// Closest point on the edge, compared by squared distance
+		float length_squared = edge_x * edge_x + edge_y * edge_y;
+		float t = (length_squared > 0) ? (delta_x * edge_x + delta_y * edge_y) / length_squared : 0;
+		t = (t < 0) ? 0 : ((t > 1) ? 1 : t);
+
+		float point_x = v1_x + edge_x * t, point_y = v1_y + edge_y * t;
+		float distance = (point_x - cx) * (point_x - cx) + (point_y - cy) * (point_y - cy);
+		if (!overlap_x && distance < cr * cr) return true; // Boolean-only: any edge within the radius is a hit
+		if (distance < closest_distance) {
+			closest_distance = distance;
+			closest_x = point_x;
+			closest_y = point_y;
+			closest_edge = i;
+			closest_t = t;
+		}
+	}
+
+	// Inside if the center is on the inner side of every edge (edges on the boundary count as inside)
+	bool inside = (area >= 0) ? (min_cross >= 0) : (max_cross <= 0);
+
+	if (!inside && closest_distance >= cr * cr) return false;
+	if (!overlap_x) return true;
+
+	closest_distance = sc2d_sqrtf(closest_distance);
+	float depth = inside ? (cr + closest_distance) : (cr - closest_distance);
+	float normal_x, normal_y; // From the circle center toward the polygon
+
+	if (closest_distance > 0) {
+		normal_x = (closest_x - cx) / closest_distance;
+		normal_y = (closest_y - cy) / closest_distance;
+		if (inside) {
+			normal_x = -normal_x;
+			normal_y = -normal_y;
+		}
+	} else { // Center on the boundary: use the inward normal of its edge
+		get_poly2d_edge(verts, closest_edge, &normal_x, &normal_y);
+		v2_normal(&normal_x, &normal_y, area < 0);
+		v2_normalize(&normal_x, &normal_y);
+	}
+
+	*overlap_x = normal_x * depth;
+	*overlap_y = normal_y * depth;
+
+	if (feature) {
+		if (closest_t > 0 && closest_t < 1) {
+			*feature = (unsigned int)closest_edge;
 		} else {
-			result = true;
+			int vertex = (closest_t > 0) ? ((closest_edge + 1 < count) ? closest_edge + 1 : 0) : closest_edge;
+			*feature = ((unsigned int)vertex << 14) | SC2D_FEATURE_CORNER;
 		}
-	// If the angle of the line pointing in the opposite direction is equal
-	// angle from start to the point,
-	// then the point is still on the (infinite) line defined by start and end
-	// but not the segment or ray defined by start and end
-	} else if (!segment && (sc2d_atan2(-line_x, -line_y) == sc2d_atan2(point_delta_y, point_delta_x)) ) {
-		result = true;
 	}
 
-	return result;
+	return true;
+}
+
+// Check for collision between a circle and a convex polygon and return the minimum translation overlap by reference
+// The overlap points from the circle toward the polygon, so subtract it from the circle to separate them.
+bool sc2d_check_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count, float* overlap_x, float* overlap_y) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_CIRCLE_POLY2D, verts, 0, overlap_x, overlap_y, cx, cy, cr, px, py);
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY2D, circle_poly_overlap(cx - px, cy - py, cr, &verts, overlap_x, overlap_y, 0));
+}
+
+// Same as sc2d_check_circle_poly2d, reading the vertices through a strided view (see sc2d_verts)
+bool sc2d_check_circle_poly2d_strided(float cx, float cy, float cr, float px, float py, sc2d_verts* poly, float* overlap_x, float* overlap_y) {
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_CIRCLE_POLY2D, *poly, 0, overlap_x, overlap_y, cx, cy, cr, px, py);
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY2D, circle_poly_overlap(cx - px, cy - py, cr, poly, overlap_x, overlap_y, 0));
+}
+
+// Check if a circle overlaps a convex polygon
+bool sc2d_test_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_TEST_CIRCLE_POLY2D, verts, 0, 0, 0, cx, cy, cr, px, py);
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLE_POLY2D, circle_poly_overlap(cx - px, cy - py, cr, &verts, 0, 0, 0));
+}
+
+// Build a convex polygon shape from vertices (relative to its position)
+// verts: count x/y pairs (or custom sc2d_v2 structs)
+// storage: 4 * count floats owned by the caller, which hold a packed copy of the vertices and the edge normals
+void sc2d_poly_init(sc2d_poly* poly, float* verts, int count, float* storage) {
+	sc2d_verts view = v2_view(verts, count);
+	sc2d_poly_init_strided(poly, &view, storage);
+}
+
+// Same as sc2d_poly_init, copying the vertices from a strided view (see sc2d_verts)
+void sc2d_poly_init_strided(sc2d_poly* poly, sc2d_verts* verts, float* storage) {
+	int count = verts->count;
+	float area = 0, centroid_x = 0, centroid_y = 0;
+
+	poly->verts = storage;
+	poly->normals = storage + count * 2;
+	poly->count = count;
+	poly->hull = 0;
+	poly->radius = 0;
+	poly->min_x = poly->min_y = INFINITY;
+	poly->max_x = poly->max_y = -INFINITY;
+
+	for (int i = 0; i < count; i++) {
+		float x = vert_x(verts, i), y = vert_y(verts, i);
+		poly->verts[i * 2] = x;
+		poly->verts[i * 2 + 1] = y;
+
+		poly->radius = sc2d_max(poly->radius, sc2d_hypotf(x, y));
+		poly->min_x = sc2d_min(poly->min_x, x);
+		poly->min_y = sc2d_min(poly->min_y, y);
+		poly->max_x = sc2d_max(poly->max_x, x);
+		poly->max_y = sc2d_max(poly->max_y, y);
+	}
+
+	for (int i = 0; i < count; i++) {
+		float* normal = poly->normals + i * 2;
+
+		// The same axes sc2d_check_poly2d computes on every call
+		get_poly2d_edge(verts, i, normal, normal + 1);
+		v2_normal(normal, normal + 1, false);
+		v2_normalize(normal, normal + 1);
+
+		// Area weighted centroid
+		float* v1 = poly->verts + i * 2;
+		float* v2 = poly->verts + ((i + 1) % count) * 2;
+		float cross = v1[0] * v2[1] - v2[0] * v1[1];
+		area += cross;
+		centroid_x += (v1[0] + v2[0]) * cross;
+		centroid_y += (v1[1] + v2[1]) * cross;
+	}
+
+	if (area != 0) {
+		poly->centroid_x = centroid_x / (3.0f * area);
+		poly->centroid_y = centroid_y / (3.0f * area);
+	} else { // Degenerate polygon (no area): use the center of its bounds
+		poly->centroid_x = (poly->min_x + poly->max_x) / 2.0f;
+		poly->centroid_y = (poly->min_y + poly->max_y) / 2.0f;
+	}
+}
+
+// Below this many vertices a linear scan beats the binary search
+#ifndef SC2D_HULL_LINEAR_MAX
+#define SC2D_HULL_LINEAR_MAX 12
+#endif
+
+// sc2d_poly_make_hull treats vertices closer than this fraction of the polygon's radius to the line through
+// their neighbors as collinear. Float rounding makes the turn of such corners meaningless.
+#ifndef SC2D_HULL_EPSILON
+#define SC2D_HULL_EPSILON 1e-6f
+#endif
+
+// Turn of the corner at v1, and whether it is too flat to count as a corner
+static inline float hull_corner(float* v0, float* v1, float* v2, float scale, bool* flat) {
+	float e1x = v1[0] - v0[0], e1y = v1[1] - v0[1];
+	float e2x = v2[0] - v1[0], e2y = v2[1] - v1[1];
+	float cross = e1x * e2y - e1y * e2x;
+	*flat = sc2d_fabsf(cross) <= SC2D_HULL_EPSILON * scale * (sc2d_fabsf(e1x) + sc2d_fabsf(e1y) + sc2d_fabsf(e2x) + sc2d_fabsf(e2y));
+	return cross;
+}
+
+// Turn an sc2d_poly into a hull: drop repeated and collinear vertices and wind it so the signed area is positive.
+// Hulls find extreme vertices and contain points in O(log n) instead of O(n).
+// Returns false (and leaves the polygon unchanged) if it is not convex or has fewer than 3 corners.
+bool sc2d_poly_make_hull(sc2d_poly* poly) {
+	float* verts = poly->verts;
+	float* ring = poly->normals; // Scratch space, the normals are rebuilt from the vertices at the end
+	int n = 0, count = 0, flips = 0;
+	float turn = 0, last_edge_x = 0;
+	bool success = true;
+
+	for (int i = 0; i < poly->count; i++) {
+		if (n > 0 && verts[i * 2] == ring[(n - 1) * 2] && verts[i * 2 + 1] == ring[(n - 1) * 2 + 1]) continue;
+		ring[n * 2] = verts[i * 2];
+		ring[n * 2 + 1] = verts[i * 2 + 1];
+		n++;
+	}
+	if (n > 1 && ring[0] == ring[(n - 1) * 2] && ring[1] == ring[(n - 1) * 2 + 1]) n--;
+
+	// Every corner turns the same way, and the edges go around exactly once
+	// (their x direction flips sign twice, self-intersecting stars flip more often)
+	for (int i = 0; i < n && success; i++) {
+		float* v1 = ring + i * 2;
+		float* v2 = ring + ((i + 1) % n) * 2;
+		bool flat;
+		float cross = hull_corner(ring + ((i + n - 1) % n) * 2, v1, v2, poly->radius, &flat);
+
+		if (flat) continue;
+		if (turn == 0) turn = cross;
+		success = (cross > 0) == (turn > 0);
+		count++;
+
+		float edge_x = v2[0] - v1[0];
+		if (edge_x != 0) {
+			flips += (last_edge_x != 0) && ((edge_x > 0) != (last_edge_x > 0));
+			last_edge_x = edge_x;
+		}
+	}
+
+	success = success && count >= 3 && flips <= 2;
+
+	// Keep only the corners, in order of positive signed area
+	if (success) {
+		count = 0;
+		for (int k = 0; k < n; k++) {
+			int i = (turn > 0) ? k : (n - 1 - k);
+			bool flat;
+			hull_corner(ring + ((i + n - 1) % n) * 2, ring + i * 2, ring + ((i + 1) % n) * 2, poly->radius, &flat);
+			if (flat) continue;
+
+			verts[count * 2] = ring[i * 2];
+			verts[count * 2 + 1] = ring[i * 2 + 1];
+			count++;
+		}
+		poly->count = count;
+		poly->hull = 1;
+	}
+
+	sc2d_verts packed = packed_view(verts, poly->count);
+	for (int i = 0; i < poly->count; i++) {
+		float* normal = poly->normals + i * 2;
+
+		get_poly2d_edge(&packed, i, normal, normal + 1);
+		v2_normal(normal, normal + 1, false);
+		v2_normalize(normal, normal + 1);
+	}
+
+	return success;
+}
+
+// Index of the hull vertex farthest along a direction
+// The heights of a convex ring rise and fall only once, so a binary search finds the top (D. Sunday, "Extreme Points of Convex Polygons")
+static int hull_extreme(float* verts, int count, float dir_x, float dir_y) {
+#define SC2D_HEIGHT(i) (dir_x * verts[((i) < count ? (i) : 0) * 2] + dir_y * verts[((i) < count ? (i) : 0) * 2 + 1])
+	if (count < SC2D_HULL_LINEAR_MAX) {
+		int best = 0;
+		float best_height = SC2D_HEIGHT(0);
+		for (int i = 1; i < count; i++) {
+			float height = SC2D_HEIGHT(i);
+			if (height > best_height) {
+				best_height = height;
+				best = i;
+			}
+		}
+		return best;
+	}
+
+	int a = 0, b = count;
+	bool up_a = SC2D_HEIGHT(1) > SC2D_HEIGHT(0);
+	if (!up_a && !(SC2D_HEIGHT(count - 1) > SC2D_HEIGHT(0))) return 0;
+
+	for (;;) {
+		int c = (a + b) / 2;
+		float height_c = SC2D_HEIGHT(c);
+		bool up_c = SC2D_HEIGHT(c + 1) > height_c;
+
+		if (!up_c && !(SC2D_HEIGHT(c - 1) > height_c)) return c;
+
+		if (up_a) {
+			if (!up_c || SC2D_HEIGHT(a) > height_c) {
+				b = c;
+			} else {
+				a = c;
+				up_a = up_c;
+			}
+		} else {
+			if (!up_c && SC2D_HEIGHT(a) < height_c) {
+				b = c;
+			} else {
+				a = c;
+				up_a = up_c;
+			}
+		}
+
+		if (b <= a + 1) return (SC2D_HEIGHT(b) > SC2D_HEIGHT(a)) ? (b < count ? b : 0) : a;
+	}
+#undef SC2D_HEIGHT
+}
+
+// Project packed x/y pairs to 2D vector axis (dot product)
+// Plain compares instead of sc2d_min/sc2d_max: fminf and fmaxf are library calls unless NaN handling is disabled,
+// and they dominate the cost of this loop.
+static inline void project_packed_to_axis(float axis_x, float axis_y, float* verts, int vert_count, float* min, float* max) {
+	float lo = 0, hi = 0;
+	SC2D_COUNT_ADD(projected_verts, vert_count);
+
+	for (int i = 0; i < vert_count; i++) {
+		float dot = (axis_x * verts[i * 2]) + (axis_y * verts[i * 2 + 1]);
+		lo = (dot < lo) ? dot : lo;
+		hi = (dot > hi) ? dot : hi;
+	}
+
+	*min = lo;
+	*max = hi;
+}
+
+// Project an sc2d_poly to an axis, searching the two extreme vertices of hulls instead of scanning all of them
+static inline void project_poly_to_axis(float axis_x, float axis_y, sc2d_poly* poly, float* min, float* max) {
+	if (!poly->hull || poly->count < SC2D_HULL_LINEAR_MAX) {
+		project_packed_to_axis(axis_x, axis_y, poly->verts, poly->count, min, max);
+		return;
+	}
+
+	float* lo = poly->verts + hull_extreme(poly->verts, poly->count, -axis_x, -axis_y) * 2;
+	float* hi = poly->verts + hull_extreme(poly->verts, poly->count, axis_x, axis_y) * 2;
+	SC2D_COUNT_ADD(projected_verts, 2);
+	float lo_dot = (axis_x * lo[0]) + (axis_y * lo[1]);
+	float hi_dot = (axis_x * hi[0]) + (axis_y * hi[1]);
+
+	// Same as project_packed_to_axis, which includes the position in the projection
+	*min = (lo_dot < 0) ? lo_dot : 0;
+	*max = (hi_dot > 0) ? hi_dot : 0;
+}
+
+// Project both polygons to one edge normal of an sc2d_poly (see poly2d_axis_overlap)
+static inline bool polys_axis_overlap(sc2d_poly* axes, int edge, sc2d_poly* p1, sc2d_poly* p2, float delta_x, float delta_y,
+									  float* distance, float* axis_x, float* axis_y) {
+	float p1_min, p1_max, p2_min, p2_max;
+	SC2D_COUNT_ADD(sat_axes, 1);
+
+	*axis_x = axes->normals[edge * 2];
+	*axis_y = axes->normals[edge * 2 + 1];
+	float offset = (*axis_x * delta_x) + (*axis_y * delta_y);
+
+	project_poly_to_axis(*axis_x, *axis_y, p1, &p1_min, &p1_max);
+	project_poly_to_axis(*axis_x, *axis_y, p2, &p2_min, &p2_max);
+
+	p1_min -= offset;
+	p1_max -= offset;
+
+	if ( (p1_min > p2_max) || (p1_max < p2_min)) {
+		return false;
+	}
+
+	*distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
+	*axis_x *= (float)(1 - 2 * (int)(offset < 0) );
+	*axis_y *= (float)(1 - 2 * (int)(offset < 0) );
+
+	return true;
+}
+
+// Check for collision between two sc2d_poly shapes and return shortest axis overlap by reference
+// Same as sc2d_check_poly2d, but uses the precomputed edge normals instead of recomputing them on every call
+bool sc2d_check_polys(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2, float* overlap_x, float* overlap_y) {
+	return sc2d_check_polys_cached(p1x, p1y, p1, p2x, p2y, p2, 0, overlap_x, overlap_y);
+}
+
+// Same as sc2d_check_polys, but first tests the axis that separated the polygons on the previous call
+// cache: caller-owned and zero initialized, one per polygon pair (or NULL)
+bool sc2d_check_polys_cached(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2,
+							 sc2d_sat_cache* cache, float* overlap_x, float* overlap_y) {
+	float axis_x, axis_y, distance;
+	float delta_x = p2x - p1x;
+	float delta_y = p2y - p1y;
+	float min_distance = INFINITY;
+
+	SC2D_TRACE_BEGIN_POLYS(SC2D_STAT_POLYS, packed_view(p1->verts, p1->count), packed_view(p2->verts, p2->count),
+		(p1->hull ? 1 : 0) | (p2->hull ? 2 : 0), overlap_x, overlap_y, p1x, p1y, p2x, p2y);
+
+	// Distant pairs never reach the axes. The projections include each polygon's position, and so does its radius.
+	if (bounds_apart(delta_x, delta_y, p1->radius + p2->radius)) return SC2D_COUNT_CALL(SC2D_STAT_POLYS, false);
+
+	if (cache && cache->poly) {
+		sc2d_poly* axes = (cache->poly == 1) ? p1 : p2;
+		if (cache->edge < axes->count &&
+			!polys_axis_overlap(axes, cache->edge, p1, p2, delta_x, delta_y, &distance, &axis_x, &axis_y)) {
+			return SC2D_COUNT_CALL(SC2D_STAT_POLYS, false);
+		}
+	}
+
+	for (int poly = 1; poly <= 2; poly++) {
+		sc2d_poly* axes = (poly == 1) ? p1 : p2;
+
+		for (int i = 0; i < axes->count; i++) {
+			if (!polys_axis_overlap(axes, i, p1, p2, delta_x, delta_y, &distance, &axis_x, &axis_y)) {
+				if (cache) {
+					cache->poly = (unsigned char)poly;
+					cache->edge = (unsigned short)i;
+				}
+				return SC2D_COUNT_CALL(SC2D_STAT_POLYS, false);
+			}
+
+			if (distance < min_distance) {
+				min_distance = distance;
+				*overlap_x = axis_x;
+				*overlap_y = axis_y;
+			}
+		}
+	}
+
+	if (cache) cache->poly = 0;
+
+	*overlap_x *= min_distance;
+	*overlap_y *= min_distance;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_POLYS, true);
+}
+
+// Check for collision between point and an sc2d_poly shape at (x, y)
+// The point is inside if it is on the same side of every edge. Hulls binary search the wedge around vertex 0 instead.
+bool sc2d_check_point_poly(float px, float py, float x, float y, sc2d_poly* poly) {
+	bool inside = false, outside = false;
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_POINT_POLY, packed_view(poly->verts, poly->count), poly->hull ? 1 : 0, 0, 0, px, py, x, y);
+
+	px -= x;
+	py -= y;
+
+	if (px < poly->min_x || px > poly->max_x || py < poly->min_y || py > poly->max_y) {
+		return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, false);
+	}
+
+	if (poly->hull) {
+		float* v = poly->verts;
+		float dx = px - v[0], dy = py - v[1];
+		int lo = 1, hi = poly->count - 1;
+
+		// Outside the fan of triangles around vertex 0
+		if ((v[2] - v[0]) * dy - (v[3] - v[1]) * dx < 0) return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, false);
+		if ((v[hi * 2] - v[0]) * dy - (v[hi * 2 + 1] - v[1]) * dx > 0) return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, false);
+
+		while (hi - lo > 1) {
+			int mid = (lo + hi) / 2;
+			if ((v[mid * 2] - v[0]) * dy - (v[mid * 2 + 1] - v[1]) * dx >= 0) lo = mid;
+			else hi = mid;
+		}
+
+		// Inside the wedge: check the hull edge that closes it
+		float* a = v + lo * 2;
+		float* b = v + hi * 2;
+		return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, (b[0] - a[0]) * (py - a[1]) - (b[1] - a[1]) * (px - a[0]) >= 0);
+	}
+
+	for (int i = 0; i < poly->count; i++) {
+		float side = poly->normals[i * 2] * (px - poly->verts[i * 2]) + poly->normals[i * 2 + 1] * (py - poly->verts[i * 2 + 1]);
+		inside |= side > 0;
+		outside |= side < 0;
+		if (inside && outside) return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, false);
+	}
+
+	return SC2D_COUNT_CALL(SC2D_STAT_POINT_POLY, true);
+}
+
+// Check for collision between a circle and an sc2d_poly shape at (x, y) (see sc2d_check_circle_poly2d)
+bool sc2d_check_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly, float* overlap_x, float* overlap_y) {
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_CIRCLE_POLY, packed_view(poly->verts, poly->count), poly->hull ? 1 : 0, overlap_x, overlap_y, cx, cy, cr, x, y);
+	if (bounds_apart(cx - x, cy - y, cr + poly->radius)) return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY, false);
+
+	sc2d_verts verts = packed_view(poly->verts, poly->count);
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY, circle_poly_overlap(cx - x, cy - y, cr, &verts, overlap_x, overlap_y, 0));
+}
+
+// Check if a circle overlaps an sc2d_poly shape at (x, y)
+bool sc2d_test_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly) {
+	SC2D_TRACE_BEGIN_POLY(SC2D_STAT_TEST_CIRCLE_POLY, packed_view(poly->verts, poly->count), poly->hull ? 1 : 0, 0, 0, cx, cy, cr, x, y);
+	if (bounds_apart(cx - x, cy - y, cr + poly->radius)) return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLE_POLY, false);
+
+	sc2d_verts verts = packed_view(poly->verts, poly->count);
+	return SC2D_COUNT_CALL(SC2D_STAT_TEST_CIRCLE_POLY, circle_poly_overlap(cx - x, cy - y, cr, &verts, 0, 0, 0));
+}
+
+// Rotate a vector from local to world space, or from world to local space with inverse
+static inline void transform_rotate(sc2d_transform* t, float* x, float* y, bool inverse) {
+	float sine = inverse ? -t->sin : t->sin;
+	float temp = *x;
+
+	*x = t->cos * temp - sine * *y;
+	*y = sine * temp + t->cos * *y;
+}
+
+// Same as poly2d_axis_overlap for polygons placed by transforms
+// The world axis is rotated into each polygon's local space, so only the axis is transformed and never the vertices.
+static bool poly2d_transformed_axis_overlap(sc2d_verts* axis_verts, sc2d_transform* axis_t, int edge,
+											sc2d_verts* p1, sc2d_transform* t1, sc2d_verts* p2, sc2d_transform* t2,
+											float* distance, float* axis_x, float* axis_y) {
+	float p1_min, p1_max, p2_min, p2_max;
+	SC2D_COUNT_ADD(sat_axes, 1);
+
+	get_poly2d_edge(axis_verts, edge, axis_x, axis_y);
+	v2_normal(axis_x, axis_y, false);
+	v2_normalize(axis_x, axis_y);
+	transform_rotate(axis_t, axis_x, axis_y, false); // Uniform scale keeps the normal's direction
+	float offset = (*axis_x * (t2->x - t1->x)) + (*axis_y * (t2->y - t1->y));
+
+	float local_x = *axis_x, local_y = *axis_y;
+	transform_rotate(t1, &local_x, &local_y, true);
+	project_poly2d_to_axis(local_x, local_y, p1, &p1_min, &p1_max);
+
+	local_x = *axis_x;
+	local_y = *axis_y;
+	transform_rotate(t2, &local_x, &local_y, true);
+	project_poly2d_to_axis(local_x, local_y, p2, &p2_min, &p2_max);
+
+	p1_min = p1_min * t1->scale - offset;
+	p1_max = p1_max * t1->scale - offset;
+	p2_min *= t2->scale;
+	p2_max *= t2->scale;
+
+	if ( (p1_min > p2_max) || (p1_max < p2_min)) {
+		return false;
+	}
+
+	*distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
+	*axis_x *= (float)(1 - 2 * (int)(offset < 0) );
+	*axis_y *= (float)(1 - 2 * (int)(offset < 0) );
+
+	return true;
+}
+
+// Check for collision between two convex polygons in local space, placed by transforms, and return shortest axis overlap by reference
+// Gives the same result as transforming every vertex and calling sc2d_check_poly2d, without copying the vertices.
+bool sc2d_check_poly2d_transformed(	float* p1_verts, int p1_count, sc2d_transform* t1,
+									float* p2_verts, int p2_count, sc2d_transform* t2,
+									float* overlap_x, float* overlap_y) {
+	float axis_x, axis_y, distance;
+	float min_distance = INFINITY;
+	sc2d_verts p1 = v2_view(p1_verts, p1_count);
+	sc2d_verts p2 = v2_view(p2_verts, p2_count);
+
+	for (int poly = 1; poly <= 2; poly++) {
+		sc2d_verts* axis_verts = (poly == 1) ? &p1 : &p2;
+		sc2d_transform* axis_t = (poly == 1) ? t1 : t2;
+
+		for (int i = 0; i < axis_verts->count; i++) {
+			if (!poly2d_transformed_axis_overlap(axis_verts, axis_t, i, &p1, t1, &p2, t2, &distance, &axis_x, &axis_y)) {
+				return SC2D_COUNT_CALL(SC2D_STAT_POLY2D_TRANSFORMED, false);
+			}
+
+			if (distance < min_distance) {
+				min_distance = distance;
+				*overlap_x = axis_x;
+				*overlap_y = axis_y;
+			}
+		}
+	}
+
+	*overlap_x *= min_distance;
+	*overlap_y *= min_distance;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_POLY2D_TRANSFORMED, true);
 }
 
+// Check for collision between two sc2d_poly shapes placed by transforms (see sc2d_check_poly2d_transformed)
+// The precomputed normals are rotated to world space, and hulls keep their O(log n) projections.
+bool sc2d_check_polys_transformed(sc2d_poly* p1, sc2d_transform* t1, sc2d_poly* p2, sc2d_transform* t2, float* overlap_x, float* overlap_y) {
+	float p1_min, p1_max, p2_min, p2_max;
+	float min_distance = INFINITY;
+
+	if (bounds_apart(t2->x - t1->x, t2->y - t1->y, p1->radius * t1->scale + p2->radius * t2->scale)) {
+		return SC2D_COUNT_CALL(SC2D_STAT_POLYS_TRANSFORMED, false);
+	}
+
+	for (int poly = 1; poly <= 2; poly++) {
+		sc2d_poly* axes = (poly == 1) ? p1 : p2;
+		sc2d_transform* axes_t = (poly == 1) ? t1 : t2;
+
+		for (int i = 0; i < axes->count; i++) {
+			float axis_x = axes->normals[i * 2], axis_y = axes->normals[i * 2 + 1];
+			SC2D_COUNT_ADD(sat_axes, 1);
+
+			transform_rotate(axes_t, &axis_x, &axis_y, false);
+			float offset = (axis_x * (t2->x - t1->x)) + (axis_y * (t2->y - t1->y));
+
+			float local_x = axis_x, local_y = axis_y;
+			transform_rotate(t1, &local_x, &local_y, true);
+			project_poly_to_axis(local_x, local_y, p1, &p1_min, &p1_max);
+
+			local_x = axis_x;
+			local_y = axis_y;
+			transform_rotate(t2, &local_x, &local_y, true);
+			project_poly_to_axis(local_x, local_y, p2, &p2_min, &p2_max);
+
+			p1_min = p1_min * t1->scale - offset;
+			p1_max = p1_max * t1->scale - offset;
+			p2_min *= t2->scale;
+			p2_max *= t2->scale;
+
+			if ( (p1_min > p2_max) || (p1_max < p2_min)) {
+				return SC2D_COUNT_CALL(SC2D_STAT_POLYS_TRANSFORMED, false);
+			}
+
+			float distance = sc2d_min(p1_max, p2_max) - sc2d_max(p1_min, p2_min);
+			if (distance < min_distance) {
+				min_distance = distance;
+				*overlap_x = axis_x * (float)(1 - 2 * (int)(offset < 0) );
+				*overlap_y = axis_y * (float)(1 - 2 * (int)(offset < 0) );
+			}
+		}
+	}
+
+	*overlap_x *= min_distance;
+	*overlap_y *= min_distance;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_POLYS_TRANSFORMED, true);
+}
+
+// Check for collision between a circle (world space) and a convex polygon in local space placed by a transform
+// The circle is moved into the polygon's local space instead, and the overlap is rotated and scaled back.
+bool sc2d_check_circle_poly2d_transformed(float cx, float cy, float cr, float* poly_verts, int vert_count, sc2d_transform* t,
+										  float* overlap_x, float* overlap_y) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	float local_x = cx - t->x, local_y = cy - t->y;
+
+	transform_rotate(t, &local_x, &local_y, true);
+	if (!circle_poly_overlap(local_x / t->scale, local_y / t->scale, cr / t->scale, &verts, overlap_x, overlap_y, 0)) {
+		return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY2D_TRANSFORMED, false);
+	}
+
+	transform_rotate(t, overlap_x, overlap_y, false);
+	*overlap_x *= t->scale;
+	*overlap_y *= t->scale;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_POLY2D_TRANSFORMED, true);
+}
+
+// Maximum number of GJK iterations and EPA polytope vertices
+#ifndef SC2D_GJK_MAX_ITERATIONS
+#define SC2D_GJK_MAX_ITERATIONS 32
+#endif
+
+#ifndef SC2D_EPA_MAX_VERTS
+#define SC2D_EPA_MAX_VERTS 32
+#endif
+
+// GJK and EPA stop when a new support point improves the distance by less than this fraction
+#ifndef SC2D_GJK_TOLERANCE
+#define SC2D_GJK_TOLERANCE 1e-5f
+#endif
+
+// Radius around the core of a shape (circles are a point, capsules a segment)
+static inline float shape_radius(sc2d_shape* shape) {
+	return (shape->type == SC2D_SHAPE_CIRCLE || shape->type == SC2D_SHAPE_CAPSULE) ? shape->r : 0;
+}
+
+// Vertices of a polygon shape, packed or in the sc2d_v2 layout (see sc2d_shape)
+static inline sc2d_verts shape_verts(sc2d_shape* shape) {
+	return shape->packed ? packed_view(shape->verts, shape->count) : v2_view(shape->verts, shape->count);
+}
+
+// Support point of the core of a shape, without its radius
+static void shape_core_support(sc2d_shape* shape, float dir_x, float dir_y, float* support_x, float* support_y) {
+	switch (shape->type) {
+		case SC2D_SHAPE_CAPSULE: {
+			float side = (dir_x * shape->w + dir_y * shape->h < 0) ? -1.0f : 1.0f;
+			*support_x = shape->x + shape->w * side;
+			*support_y = shape->y + shape->h * side;
+		} break;
+
+		case SC2D_SHAPE_RECT: {
+			*support_x = shape->x + ((dir_x > 0) ? shape->w : 0);
+			*support_y = shape->y + ((dir_y > 0) ? shape->h : 0);
+		} break;
+
+		case SC2D_SHAPE_POLY: {
+			sc2d_verts verts = shape_verts(shape);
+			int best = 0;
+			float best_dot = -INFINITY;
+
+			for (int i = 0; i < shape->count; i++) {
+				float dot = dir_x * vert_x(&verts, i) + dir_y * vert_y(&verts, i);
+				if (dot > best_dot) {
+					best_dot = dot;
+					best = i;
+				}
+			}
+
+			*support_x = shape->x + vert_x(&verts, best);
+			*support_y = shape->y + vert_y(&verts, best);
+		} break;
+
+		default: {
+			*support_x = shape->x;
+			*support_y = shape->y;
+		} break;
+	}
+}
+
+// Get the point of a shape farthest in a direction (support mapping)
+void sc2d_shape_support(sc2d_shape* shape, float dir_x, float dir_y, float* support_x, float* support_y) {
+	shape_core_support(shape, dir_x, dir_y, support_x, support_y);
+
+	float radius = shape_radius(shape);
+	float magnitude = sc2d_hypotf(dir_x, dir_y);
+	if (radius > 0 && magnitude > 0) {
+		*support_x += (dir_x / magnitude) * radius;
+		*support_y += (dir_y / magnitude) * radius;
+	}
+}
+
+// Support point of the Minkowski difference of the cores, s1 - s2
+static inline void minkowski_support(sc2d_shape* s1, sc2d_shape* s2, float dir_x, float dir_y, float* x, float* y) {
+	float x1, y1, x2, y2;
+	shape_core_support(s1, dir_x, dir_y, &x1, &y1);
+	shape_core_support(s2, -dir_x, -dir_y, &x2, &y2);
+	*x = x1 - x2;
+	*y = y1 - y2;
+}
+
+// Center of a shape, used as the starting search direction
+static inline void shape_center(sc2d_shape* shape, float* x, float* y) {
+	*x = shape->x + ((shape->type == SC2D_SHAPE_RECT) ? shape->w / 2.0f : 0);
+	*y = shape->y + ((shape->type == SC2D_SHAPE_RECT) ? shape->h / 2.0f : 0);
+}
+
+// Reduce a simplex (up to 3 x/y pairs) to the smallest subset containing the point closest to the origin.
+// Returns true if the origin is inside the triangle.
+static bool simplex_closest(float* simplex, int* count, float* closest_x, float* closest_y) {
+	float ax = simplex[0], ay = simplex[1];
+
+	if (*count == 1) {
+		*closest_x = ax;
+		*closest_y = ay;
+		return false;
+	}
+
+	float bx = simplex[2], by = simplex[3];
+	float abx = bx - ax, aby = by - ay;
+
+	if (*count == 2) {
+		float length_squared = abx * abx + aby * aby;
+		float t = (length_squared > 0) ? -(ax * abx + ay * aby) / length_squared : 0;
+
+		if (t <= 0) {
+			*count = 1;
+		} else if (t >= 1) {
+			simplex[0] = bx; simplex[1] = by;
+			*count = 1;
+		}
+		t = sc2d_max(0, sc2d_min(t, 1));
+		*closest_x = ax + abx * t;
+		*closest_y = ay + aby * t;
+		return false;
+	}
+
+	// Triangle: test the Voronoi regions of the vertices and edges (Real-Time Collision Detection, 5.1.5)
+	float cx = simplex[4], cy = simplex[5];
+	float acx = cx - ax, acy = cy - ay;
+
+	float d1 = -(abx * ax + aby * ay), d2 = -(acx * ax + acy * ay);
+	if (d1 <= 0 && d2 <= 0) {
+		*count = 1;
+		*closest_x = ax; *closest_y = ay;
+		return false;
+	}
+
+	float d3 = -(abx * bx + aby * by), d4 = -(acx * bx + acy * by);
+	if (d3 >= 0 && d4 <= d3) {
+		simplex[0] = bx; simplex[1] = by;
+		*count = 1;
+		*closest_x = bx; *closest_y = by;
+		return false;
+	}
+
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+		float t = d1 / (d1 - d3);
+		*count = 2;
+		*closest_x = ax + abx * t; *closest_y = ay + aby * t;
+		return false;
+	}
+
+	float d5 = -(abx * cx + aby * cy), d6 = -(acx * cx + acy * cy);
+	if (d6 >= 0 && d5 <= d6) {
+		simplex[0] = cx; simplex[1] = cy;
+		*count = 1;
+		*closest_x = cx; *closest_y = cy;
+		return false;
+	}
+
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+		float t = d2 / (d2 - d6);
+		simplex[2] = cx; simplex[3] = cy;
+		*count = 2;
+		*closest_x = ax + acx * t; *closest_y = ay + acy * t;
+		return false;
+	}
+
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+		float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		simplex[0] = cx; simplex[1] = cy;
+		*count = 2;
+		*closest_x = bx + (cx - bx) * t; *closest_y = by + (cy - by) * t;
+		return false;
+	}
+
+	*closest_x = 0;
+	*closest_y = 0;
+	return true;
+}
+
+// Run GJK on the cores of two shapes. simplex holds up to 3 x/y pairs.
+// Returns true if the cores overlap or touch, otherwise closest is the point of the core difference nearest to the origin.
+static bool gjk(sc2d_shape* s1, sc2d_shape* s2, float* simplex, int* simplex_count, float* closest_x, float* closest_y) {
+	float c1x, c1y, c2x, c2y;
+	shape_center(s1, &c1x, &c1y);
+	shape_center(s2, &c2x, &c2y);
+
+	float dir_x = c1x - c2x;
+	float dir_y = c1y - c2y;
+	if (dir_x == 0 && dir_y == 0) dir_x = 1.0f;
+
+	int count = 1;
+	minkowski_support(s1, s2, dir_x, dir_y, simplex, simplex + 1);
+	float vx = simplex[0], vy = simplex[1];
+	float scale = vx * vx + vy * vy;
+	bool overlap = false;
+
+	for (int iteration = 0; iteration < SC2D_GJK_MAX_ITERATIONS; iteration++) {
+		float v_squared = vx * vx + vy * vy;
+		if (v_squared <= SC2D_GJK_TOLERANCE * SC2D_GJK_TOLERANCE * scale) {
+			overlap = true; // The origin is on the simplex
+			break;
+		}
+
+		float* w = simplex + count * 2;
+		minkowski_support(s1, s2, -vx, -vy, w, w + 1);
+		scale = sc2d_max(scale, w[0] * w[0] + w[1] * w[1]);
+
+		// No support point gets meaningfully closer to the origin than the current one
+		if (v_squared - (vx * w[0] + vy * w[1]) <= SC2D_GJK_TOLERANCE * v_squared) break;
+
+		count++;
+		if ((overlap = simplex_closest(simplex, &count, &vx, &vy))) break;
+	}
+
+	*simplex_count = count;
+	*closest_x = vx;
+	*closest_y = vy;
+	return overlap;
+}
+
+// Penetration of two overlapping cores along the shortest separating direction (EPA). The simplex must contain the origin.
+// Flat core differences (points and segments) get a zero depth and a normal facing from s1 to s2.
+static float epa(sc2d_shape* s1, sc2d_shape* s2, float* simplex, int count, float* normal_x, float* normal_y) {
+	float polytope[SC2D_EPA_MAX_VERTS * 2];
+	for (int i = 0; i < count * 2; i++) polytope[i] = simplex[i];
+
+	float c1x, c1y, c2x, c2y;
+	shape_center(s1, &c1x, &c1y);
+	shape_center(s2, &c2x, &c2y);
+	float center_x = c2x - c1x, center_y = c2y - c1y;
+	if (center_x == 0 && center_y == 0) center_x = 1.0f;
+
+	// Grow a point or segment into a triangle around the origin, or stop if the core difference is flat
+	if (count == 1) {
+		minkowski_support(s1, s2, center_x, center_y, polytope + 2, polytope + 3);
+		if (polytope[2] == polytope[0] && polytope[3] == polytope[1]) {
+			minkowski_support(s1, s2, -center_x, -center_y, polytope + 2, polytope + 3);
+		}
+		if (polytope[2] == polytope[0] && polytope[3] == polytope[1]) {
+			float magnitude = sc2d_hypotf(center_x, center_y);
+			*normal_x = center_x / magnitude;
+			*normal_y = center_y / magnitude;
+			return 0;
+		}
+		count = 2;
+	}
+
+	if (count == 2) {
+		float nx = polytope[2] - polytope[0];
+		float ny = polytope[3] - polytope[1];
+		v2_normal(&nx, &ny, false);
+		v2_normalize(&nx, &ny);
+
+		float flat = SC2D_GJK_TOLERANCE * sc2d_max(1.0f, sc2d_fabsf(polytope[0]) + sc2d_fabsf(polytope[1]));
+		float side = 0;
+		for (int attempt = 0; attempt < 2 && side <= flat; attempt++) {
+			if (attempt) {
+				nx = -nx;
+				ny = -ny;
+			}
+			minkowski_support(s1, s2, nx, ny, polytope + 4, polytope + 5);
+			side = (polytope[4] - polytope[0]) * nx + (polytope[5] - polytope[1]) * ny;
+		}
+
+		if (side <= flat) {
+			if (nx * center_x + ny * center_y < 0) {
+				nx = -nx;
+				ny = -ny;
+			}
+			*normal_x = nx;
+			*normal_y = ny;
+			return 0;
+		}
+		count = 3;
+	}
+
+	// Wind the polytope counterclockwise so edge normals (y, -x) point outward
+	float winding = (polytope[2] - polytope[0]) * (polytope[5] - polytope[1]) - (polytope[3] - polytope[1]) * (polytope[4] - polytope[0]);
+	if (winding < 0) {
+		float temp_x = polytope[2], temp_y = polytope[3];
+		polytope[2] = polytope[4]; polytope[3] = polytope[5];
+		polytope[4] = temp_x; polytope[5] = temp_y;
+	}
+
+	// Expand the polytope toward the boundary of the core difference until the closest edge stops moving
+	float distance = 0;
+	for (;;) {
+		int closest = 0;
+		distance = INFINITY;
+
+		for (int i = 0; i < count; i++) {
+			float* v1 = polytope + i * 2;
+			float* v2 = polytope + ((i + 1) % count) * 2;
+			float edge_x = v2[0] - v1[0], edge_y = v2[1] - v1[1];
+			float edge_length = sc2d_hypotf(edge_x, edge_y);
+			if (edge_length == 0) continue;
+
+			float nx = edge_y / edge_length, ny = -edge_x / edge_length;
+			float edge_distance = nx * v1[0] + ny * v1[1];
+			if (edge_distance < distance) {
+				distance = edge_distance;
+				*normal_x = nx;
+				*normal_y = ny;
+				closest = i;
+			}
+		}
+
+		float support_x, support_y;
+		minkowski_support(s1, s2, *normal_x, *normal_y, &support_x, &support_y);
+		float support_distance = support_x * *normal_x + support_y * *normal_y;
+
+		if (support_distance - distance <= SC2D_GJK_TOLERANCE * sc2d_max(1.0f, distance) || count == SC2D_EPA_MAX_VERTS) break;
+
+		// Insert the support point between the vertices of the closest edge
+		for (int i = count; i > closest + 1; i--) {
+			polytope[i * 2] = polytope[(i - 1) * 2];
+			polytope[i * 2 + 1] = polytope[(i - 1) * 2 + 1];
+		}
+		polytope[(closest + 1) * 2] = support_x;
+		polytope[(closest + 1) * 2 + 1] = support_y;
+		count++;
+	}
+
+	return sc2d_max(distance, 0);
+}
+
+// Check for intersection between two convex shapes (GJK)
+bool sc2d_check_gjk(sc2d_shape* s1, sc2d_shape* s2) {
+	float simplex[6], closest_x, closest_y;
+	int count;
+	if (gjk(s1, s2, simplex, &count, &closest_x, &closest_y)) return SC2D_COUNT_CALL(SC2D_STAT_GJK, true);
+
+	float radius = shape_radius(s1) + shape_radius(s2);
+	return SC2D_COUNT_CALL(SC2D_STAT_GJK, (closest_x * closest_x + closest_y * closest_y) < radius * radius);
+}
+
+// Check for collision between two convex shapes and return the shortest overlap by reference (GJK + EPA)
+// Circles and capsules are handled as a point or segment plus a radius, so curved shapes stay exact without tessellation.
+bool sc2d_check_shapes(sc2d_shape* s1, sc2d_shape* s2, float* overlap_x, float* overlap_y) {
+	float simplex[6], closest_x, closest_y;
+	int count;
+	float radius = shape_radius(s1) + shape_radius(s2);
+
+	if (!gjk(s1, s2, simplex, &count, &closest_x, &closest_y)) {
+		// Separate cores: the shapes overlap by whatever the radii cover of the gap
+		float distance = sc2d_hypotf(closest_x, closest_y);
+		if (distance >= radius) return SC2D_COUNT_CALL(SC2D_STAT_SHAPES, false);
+
+		*overlap_x = -(closest_x / distance) * (radius - distance);
+		*overlap_y = -(closest_y / distance) * (radius - distance);
+		return SC2D_COUNT_CALL(SC2D_STAT_SHAPES, true);
+	}
+
+	float normal_x = 0, normal_y = 0;
+	float depth = epa(s1, s2, simplex, count, &normal_x, &normal_y) + radius;
+	if (depth <= 0) return SC2D_COUNT_CALL(SC2D_STAT_SHAPES, false); // Only touching
+
+	*overlap_x = normal_x * depth;
+	*overlap_y = normal_y * depth;
+
+	return SC2D_COUNT_CALL(SC2D_STAT_SHAPES, true);
+}
+
+// Check for collision between two shapes of any type with the matching sc2d_check_* function
+// Pairs without a dedicated check (capsules, rects with polygons) use sc2d_check_shapes.
+bool sc2d_collide(sc2d_shape* s1, sc2d_shape* s2, float* overlap_x, float* overlap_y) {
+	bool result = false;
+	bool flip = false;
+	sc2d_verts verts1, verts2;
+
+	switch (s1->type * 4 + s2->type) {
+		case SC2D_SHAPE_CIRCLE * 4 + SC2D_SHAPE_CIRCLE:
+			result = sc2d_check_circles(s1->x, s1->y, s1->r, s2->x, s2->y, s2->r, overlap_x, overlap_y);
+			break;
+
+		case SC2D_SHAPE_CIRCLE * 4 + SC2D_SHAPE_RECT:
+			result = sc2d_check_circle_rect(s1->x, s1->y, s1->r, s2->x, s2->y, s2->w, s2->h, overlap_x, overlap_y);
+			break;
+
+		case SC2D_SHAPE_RECT * 4 + SC2D_SHAPE_CIRCLE:
+			result = sc2d_check_circle_rect(s2->x, s2->y, s2->r, s1->x, s1->y, s1->w, s1->h, overlap_x, overlap_y);
+			flip = true;
+			break;
+
+		case SC2D_SHAPE_RECT * 4 + SC2D_SHAPE_RECT:
+			result = sc2d_check_rects(s1->x, s1->y, s1->w, s1->h, s2->x, s2->y, s2->w, s2->h, overlap_x, overlap_y);
+			break;
+
+		case SC2D_SHAPE_CIRCLE * 4 + SC2D_SHAPE_POLY:
+			verts2 = shape_verts(s2);
+			result = sc2d_check_circle_poly2d_strided(s1->x, s1->y, s1->r, s2->x, s2->y, &verts2, overlap_x, overlap_y);
+			break;
+
+		case SC2D_SHAPE_POLY * 4 + SC2D_SHAPE_CIRCLE:
+			verts1 = shape_verts(s1);
+			result = sc2d_check_circle_poly2d_strided(s2->x, s2->y, s2->r, s1->x, s1->y, &verts1, overlap_x, overlap_y);
+			flip = true;
+			break;
+
+		case SC2D_SHAPE_POLY * 4 + SC2D_SHAPE_POLY:
+			verts1 = shape_verts(s1);
+			verts2 = shape_verts(s2);
+			result = sc2d_check_poly2d_strided(s1->x, s1->y, &verts1, s2->x, s2->y, &verts2, overlap_x, overlap_y);
+			break;
+
+		default:
+			result = sc2d_check_shapes(s1, s2, overlap_x, overlap_y);
+			break;
+	}
+
+	// The circle was passed first, so the overlap is relative to s2
+	if (result && flip) {
+		*overlap_x *= -1;
+		*overlap_y *= -1;
+	}
+
+	return SC2D_COUNT_CALL(SC2D_STAT_COLLIDE, result);
+}
+
+// Check every pair of shapes with sc2d_collide and write the colliding pairs to hits, in pair order
+// hits must have room for pair_count results. Returns the number of hits written.
+int sc2d_collide_pairs(sc2d_shape* shapes, sc2d_pair* pairs, int pair_count, sc2d_hit* hits) {
+	int hit_count = 0;
+
+	for (int i = 0; i < pair_count; i++) {
+		sc2d_hit* hit = hits + hit_count;
+
+		if (sc2d_collide(shapes + pairs[i].a, shapes + pairs[i].b, &hit->overlap_x, &hit->overlap_y)) {
+			hit->a = pairs[i].a;
+			hit->b = pairs[i].b;
+			hit_count++;
+		}
+	}
+
+	return hit_count;
+}
+
+// Ray casts
+// The internal casts take the segment as start + t * delta and only report hits up to max_fraction,
+// so sc2d_raycast_shapes can skip everything behind the closest hit found so far.
+
+// Hit at fraction 0 for segments that start inside a shape
+static inline void ray_start_inside(float delta_x, float delta_y, float* fraction, float* normal_x, float* normal_y) {
+	float length = sc2d_sqrtf(delta_x * delta_x + delta_y * delta_y);
+
+	*fraction = 0;
+	*normal_x = (length > 0) ? -delta_x / length : 0;
+	*normal_y = (length > 0) ? -delta_y / length : 0;
+}
+
+static bool ray_circle(float start_x, float start_y, float delta_x, float delta_y, float max_fraction, float cx, float cy, float cr,
+					   float* fraction, float* normal_x, float* normal_y) {
+	float f_x = start_x - cx, f_y = start_y - cy;
+	float c = f_x * f_x + f_y * f_y - cr * cr;
+
+	if (c <= 0) {
+		ray_start_inside(delta_x, delta_y, fraction, normal_x, normal_y);
+		return true;
+	}
+
+	// Smaller root of |f + t * delta|^2 = r^2
+	float a = delta_x * delta_x + delta_y * delta_y;
+	float b = f_x * delta_x + f_y * delta_y;
+	float discriminant = b * b - a * c;
+	if (b >= 0 || discriminant < 0 || a == 0) return false; // Moving away, or the line misses the circle
+
+	float t = (-b - sc2d_sqrtf(discriminant)) / a;
+	if (t > max_fraction) return false;
+
+	// Hit point relative to the center, scaled by its own length, since the radius can be zero (point sweeps). A point
+	// hit exactly at the center takes the direction back toward the start instead.
+	float n_x = f_x + delta_x * t, n_y = f_y + delta_y * t;
+	float length = sc2d_sqrtf(n_x * n_x + n_y * n_y);
+	if (length == 0) {
+		n_x = f_x;
+		n_y = f_y;
+		length = sc2d_sqrtf(n_x * n_x + n_y * n_y);
+	}
+
+	*fraction = t;
+	*normal_x = n_x / length;
+	*normal_y = n_y / length;
+	return true;
+}
+
+static bool ray_rect(float start_x, float start_y, float delta_x, float delta_y, float max_fraction, float rx, float ry, float rw, float rh,
+					 float* fraction, float* normal_x, float* normal_y) {
+	float t_enter = 0, t_exit = max_fraction;
+	int enter_axis = -1;
+	float enter_sign = 0;
+
+	// Slab test: clip the segment to the rect's x range, then its y range
+	for (int axis = 0; axis < 2; axis++) {
+		float start = axis ? start_y : start_x;
+		float delta = axis ? delta_y : delta_x;
+		float lo = axis ? ry : rx;
+		float hi = lo + (axis ? rh : rw);
+
+		if (delta == 0) {
+			if (start < lo || start > hi) return false;
+			continue;
+		}
+
+		float inverse = 1.0f / delta;
+		float t_lo = (lo - start) * inverse;
+		float t_hi = (hi - start) * inverse;
+		float sign = -1.0f; // Normal of the side entered first
+
+		if (t_lo > t_hi) {
+			float temp = t_lo;
+			t_lo = t_hi;
+			t_hi = temp;
+			sign = 1.0f;
+		}
+
+		if (t_lo > t_enter) {
+			t_enter = t_lo;
+			enter_axis = axis;
+			enter_sign = sign;
+		}
+		t_exit = (t_hi < t_exit) ? t_hi : t_exit;
+		if (t_enter > t_exit) return false;
+	}
+
+	if (enter_axis < 0) {
+		ray_start_inside(delta_x, delta_y, fraction, normal_x, normal_y);
+		return true;
+	}
+
+	*fraction = t_enter;
+	*normal_x = enter_axis ? 0 : enter_sign;
+	*normal_y = enter_axis ? enter_sign : 0;
+	return true;
+}
+
+// Clip the segment against the inner side of every edge (Cyrus-Beck)
+// normals: unit edge normals, or NULL to compute them from the edges. inward: +1 if the left normals of the edges
+// point into the polygon, -1 if they point out.
+static bool ray_poly(float start_x, float start_y, float delta_x, float delta_y, float max_fraction, sc2d_verts* verts, float* normals,
+					 float inward, float* fraction, float* normal_x, float* normal_y) {
+	float t_enter = 0, t_exit = max_fraction;
+	int enter_edge = -1;
+
+	for (int i = 0; i < verts->count; i++) {
+		float n_x, n_y;
+
+		if (normals) {
+			n_x = normals[i * 2];
+			n_y = normals[i * 2 + 1];
+		} else {
+			get_poly2d_edge(verts, i, &n_x, &n_y);
+			v2_normal(&n_x, &n_y, false);
+		}
+		n_x *= inward;
+		n_y *= inward;
+
+		// Inside this edge while distance + t * speed >= 0
+		float distance = n_x * (start_x - vert_x(verts, i)) + n_y * (start_y - vert_y(verts, i));
+		float speed = n_x * delta_x + n_y * delta_y;
+
+		if (speed == 0) {
+			if (distance < 0) return false; // Parallel and outside
+			continue;
+		}
+
+		float t = -distance / speed;
+		if (speed > 0) {
+			if (t > t_enter) {
+				t_enter = t;
+				enter_edge = i;
+			}
+		} else {
+			t_exit = (t < t_exit) ? t : t_exit;
+		}
+
+		if (t_enter > t_exit) return false;
+	}
+
+	if (enter_edge < 0) {
+		ray_start_inside(delta_x, delta_y, fraction, normal_x, normal_y);
+		return true;
+	}
+
+	// Outward normal of the entered edge
+	float n_x, n_y;
+	if (normals) {
+		n_x = normals[enter_edge * 2];
+		n_y = normals[enter_edge * 2 + 1];
+	} else {
+		get_poly2d_edge(verts, enter_edge, &n_x, &n_y);
+		v2_normal(&n_x, &n_y, false);
+		v2_normalize(&n_x, &n_y);
+	}
+
+	*fraction = t_enter;
+	*normal_x = -n_x * inward;
+	*normal_y = -n_y * inward;
+	return true;
+}
+
+// Sign that turns the left normals of a polygon's edges inward, from the sign of its area
+static float poly2d_inward(sc2d_verts* verts) {
+	float area = 0;
+
+	for (int i = 0; i < verts->count; i++) {
+		int next = (i + 1 < verts->count) ? i + 1 : 0;
+		area += vert_x(verts, i) * vert_y(verts, next) - vert_x(verts, next) * vert_y(verts, i);
+	}
+
+	return (area >= 0) ? 1.0f : -1.0f;
+}
+
+// Sign that turns the normals of an sc2d_poly inward, from the side of its first edge the centroid is on
+static inline float poly_inward(sc2d_poly* poly) {
+	float side = poly->normals[0] * (poly->centroid_x - poly->verts[0]) + poly->normals[1] * (poly->centroid_y - poly->verts[1]);
+	return (side >= 0) ? 1.0f : -1.0f;
+}
+
+// A capsule is the union of its two end circles and the rectangle between them, so the segment enters it
+// where it enters the first of the three
+static bool ray_capsule(float start_x, float start_y, float delta_x, float delta_y, float max_fraction, sc2d_shape* capsule,
+						float* fraction, float* normal_x, float* normal_y) {
+	float a_x = capsule->x - capsule->w, a_y = capsule->y - capsule->h;
+	float b_x = capsule->x + capsule->w, b_y = capsule->y + capsule->h;
+	bool result = false;
+
+	if (ray_circle(start_x, start_y, delta_x, delta_y, max_fraction, a_x, a_y, capsule->r, fraction, normal_x, normal_y)) {
+		result = true;
+		max_fraction = *fraction;
+	}
+	if (ray_circle(start_x, start_y, delta_x, delta_y, max_fraction, b_x, b_y, capsule->r, fraction, normal_x, normal_y)) {
+		result = true;
+		max_fraction = *fraction;
+	}
+
+	float side_x = -capsule->h, side_y = capsule->w;
+	float length = sc2d_sqrtf(side_x * side_x + side_y * side_y);
+	if (length > 0) {
+		side_x *= capsule->r / length;
+		side_y *= capsule->r / length;
+
+		float quad[8] = {a_x - side_x, a_y - side_y, b_x - side_x, b_y - side_y, b_x + side_x, b_y + side_y, a_x + side_x, a_y + side_y};
+		sc2d_verts verts = packed_view(quad, 4);
+		if (ray_poly(start_x, start_y, delta_x, delta_y, max_fraction, &verts, 0, 1.0f, fraction, normal_x, normal_y)) {
+			result = true;
+		}
+	}
+
+	return result;
+}
+
+static bool ray_shape(float start_x, float start_y, float delta_x, float delta_y, float max_fraction, sc2d_shape* shape,
+					  float* fraction, float* normal_x, float* normal_y) {
+	switch (shape->type) {
+		case SC2D_SHAPE_CIRCLE:
+			return ray_circle(start_x, start_y, delta_x, delta_y, max_fraction, shape->x, shape->y, shape->r, fraction, normal_x, normal_y);
+
+		case SC2D_SHAPE_RECT:
+			return ray_rect(start_x, start_y, delta_x, delta_y, max_fraction, shape->x, shape->y, shape->w, shape->h, fraction, normal_x, normal_y);
+
+		case SC2D_SHAPE_CAPSULE:
+			return ray_capsule(start_x, start_y, delta_x, delta_y, max_fraction, shape, fraction, normal_x, normal_y);
+
+		case SC2D_SHAPE_POLY: {
+			sc2d_verts verts = shape_verts(shape);
+			return ray_poly(start_x - shape->x, start_y - shape->y, delta_x, delta_y, max_fraction, &verts, 0, poly2d_inward(&verts),
+							fraction, normal_x, normal_y);
+		}
+
+		default:
+			return false;
+	}
+}
+
+// Cast a segment against a circle and return the hit fraction and normal by reference
+bool sc2d_raycast_circle(float start_x, float start_y, float end_x, float end_y, float cx, float cy, float cr,
+						 float* fraction, float* normal_x, float* normal_y) {
+	return ray_circle(start_x, start_y, end_x - start_x, end_y - start_y, 1.0f, cx, cy, cr, fraction, normal_x, normal_y);
+}
+
+// Cast a segment against a rectangle (left x, top y, width, height) and return the hit fraction and normal by reference
+bool sc2d_raycast_rect(float start_x, float start_y, float end_x, float end_y, float rx, float ry, float rw, float rh,
+					   float* fraction, float* normal_x, float* normal_y) {
+	return ray_rect(start_x, start_y, end_x - start_x, end_y - start_y, 1.0f, rx, ry, rw, rh, fraction, normal_x, normal_y);
+}
+
+// Cast a segment against a convex polygon at (px, py) and return the hit fraction and normal by reference
+// Either winding works. poly_verts: x/y pairs (or custom sc2d_v2 structs), relative to the polygon's position.
+bool sc2d_raycast_poly2d(float start_x, float start_y, float end_x, float end_y, float px, float py, float* poly_verts, int vert_count,
+						 float* fraction, float* normal_x, float* normal_y) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	return ray_poly(start_x - px, start_y - py, end_x - start_x, end_y - start_y, 1.0f, &verts, 0, poly2d_inward(&verts),
+					fraction, normal_x, normal_y);
+}
+
+// Cast a segment against an sc2d_poly shape at (x, y), using its precomputed normals
+bool sc2d_raycast_poly(float start_x, float start_y, float end_x, float end_y, float x, float y, sc2d_poly* poly,
+					   float* fraction, float* normal_x, float* normal_y) {
+	sc2d_verts verts = packed_view(poly->verts, poly->count);
+	return ray_poly(start_x - x, start_y - y, end_x - start_x, end_y - start_y, 1.0f, &verts, poly->normals, poly_inward(poly),
+					fraction, normal_x, normal_y);
+}
+
+// Cast a segment against any sc2d_shape
+bool sc2d_raycast_shape(float start_x, float start_y, float end_x, float end_y, sc2d_shape* shape,
+						float* fraction, float* normal_x, float* normal_y) {
+	return ray_shape(start_x, start_y, end_x - start_x, end_y - start_y, 1.0f, shape, fraction, normal_x, normal_y);
+}
+
+// Cast every ray against every shape and write the closest hit of each ray to hits (ray_count results)
+// Shapes behind the closest hit so far are rejected early. For large shape sets, collect candidates per ray
+// with sc2d_bvh_query_ray first. Returns the number of rays that hit a shape.
+int sc2d_raycast_shapes(sc2d_ray* rays, int ray_count, sc2d_shape* shapes, int shape_count, sc2d_ray_hit* hits) {
+	int hit_count = 0;
+
+	for (int i = 0; i < ray_count; i++) {
+		sc2d_ray* ray = rays + i;
+		sc2d_ray_hit* hit = hits + i;
+		float delta_x = ray->end_x - ray->start_x;
+		float delta_y = ray->end_y - ray->start_y;
+		float fraction, normal_x, normal_y;
+
+		hit->shape = -1;
+		hit->fraction = 1.0f;
+		hit->normal_x = hit->normal_y = 0;
+
+		for (int s = 0; s < shape_count; s++) {
+			if (ray_shape(ray->start_x, ray->start_y, delta_x, delta_y, hit->fraction, shapes + s, &fraction, &normal_x, &normal_y) &&
+				(hit->shape < 0 || fraction < hit->fraction)) {
+				hit->shape = s;
+				hit->fraction = fraction;
+				hit->normal_x = normal_x;
+				hit->normal_y = normal_y;
+			}
+		}
+
+		hit_count += (hit->shape >= 0);
+	}
+
+	return hit_count;
+}
+
+// Swept tests
+// The first shape moves relative to the second, so the sweep is a ray cast of its center (or corner) against the
+// Minkowski sum of both shapes. Rounded sums are cast as the union of their convex pieces: the first piece the ray
+// enters is where it enters the sum.
+
+// Turn the outward normal of the hit surface into the normal from the first shape toward the second
+static inline bool sweep_result(bool hit, float* normal_x, float* normal_y) {
+	if (hit) {
+		*normal_x = -*normal_x;
+		*normal_y = -*normal_y;
+	}
+	return hit;
+}
+
+// Normal of a sweep that hits at time 0. Shapes that already overlap take the direction of the static check's overlap,
+// which separates them, instead of the reversed motion, or the direction between their centers when the check has no
+// direction (contained shapes). Touching shapes keep the normal of the surface they move into, if they move.
+static void sweep_start_normal(bool overlap, float overlap_x, float overlap_y, float center_x, float center_y,
+							   float* normal_x, float* normal_y) {
+	if (!overlap && (*normal_x != 0 || *normal_y != 0)) return;
+
+	if (!overlap || (overlap_x == 0 && overlap_y == 0)) {
+		overlap_x = center_x;
+		overlap_y = center_y;
+	}
+
+	float length = sc2d_sqrtf(overlap_x * overlap_x + overlap_y * overlap_y);
+	*normal_x = (length > 0) ? overlap_x / length : 1.0f; // Same centers: any direction works
+	*normal_y = (length > 0) ? overlap_y / length : 0.0f;
+}
+
+// Check for collision between two moving circles and return the time of impact and normal by reference
+bool sc2d_sweep_circles(float p1x, float p1y, float r1, float v1x, float v1y, float p2x, float p2y, float r2, float v2x, float v2y,
+						float* toi, float* normal_x, float* normal_y) {
+	bool hit = sweep_result(ray_circle(p1x, p1y, v1x - v2x, v1y - v2y, 1.0f, p2x, p2y, r1 + r2, toi, normal_x, normal_y), normal_x, normal_y);
+
+	if (hit && *toi == 0) {
+		float delta_x = p2x - p1x, delta_y = p2y - p1y;
+		sweep_start_normal(true, delta_x, delta_y, delta_x, delta_y, normal_x, normal_y);
+	}
+	return hit;
+}
+
+// Check for collision between a moving circle and a moving rectangle (left x, top y, width, height)
+// The sum of the rect and the circle is a rounded rect: two crossed rects and a circle on each corner.
+bool sc2d_sweep_circle_rect(float cx, float cy, float cr, float v1x, float v1y, float rx, float ry, float rw, float rh, float v2x, float v2y,
+							float* toi, float* normal_x, float* normal_y) {
+	float delta_x = v1x - v2x, delta_y = v1y - v2y;
+	float max_fraction = 1.0f;
+	bool hit = false;
+
+	if (ray_rect(cx, cy, delta_x, delta_y, max_fraction, rx - cr, ry, rw + 2 * cr, rh, toi, normal_x, normal_y)) {
+		hit = true;
+		max_fraction = *toi;
+	}
+	if (ray_rect(cx, cy, delta_x, delta_y, max_fraction, rx, ry - cr, rw, rh + 2 * cr, toi, normal_x, normal_y)) {
+		hit = true;
+		max_fraction = *toi;
+	}
+
+	for (int corner = 0; corner < 4; corner++) {
+		float corner_x = rx + ((corner & 1) ? rw : 0);
+		float corner_y = ry + ((corner & 2) ? rh : 0);
+
+		if (ray_circle(cx, cy, delta_x, delta_y, max_fraction, corner_x, corner_y, cr, toi, normal_x, normal_y)) {
+			hit = true;
+			max_fraction = *toi;
+		}
+	}
+
+	if (sweep_result(hit, normal_x, normal_y) && *toi == 0) {
+		float overlap_x = 0, overlap_y = 0;
+		bool overlap = sc2d_check_circle_rect(cx, cy, cr, rx, ry, rw, rh, &overlap_x, &overlap_y);
+		sweep_start_normal(overlap, overlap_x, overlap_y, rx + rw / 2 - cx, ry + rh / 2 - cy, normal_x, normal_y);
+	}
+	return hit;
+}
+
+// Check for collision between two moving rectangles (left x, top y, width, height)
+bool sc2d_sweep_rects(float p1x, float p1y, float r1w, float r1h, float v1x, float v1y, float p2x, float p2y, float r2w, float r2h, float v2x, float v2y,
+					  float* toi, float* normal_x, float* normal_y) {
+	// The top left corner of the first rect against the second rect grown by the size of the first
+	bool hit = ray_rect(p1x, p1y, v1x - v2x, v1y - v2y, 1.0f, p2x - r1w, p2y - r1h, r1w + r2w, r1h + r2h, toi, normal_x, normal_y);
+
+	if (sweep_result(hit, normal_x, normal_y) && *toi == 0) {
+		float overlap_x = 0, overlap_y = 0;
+		bool overlap = sc2d_check_rects(p1x, p1y, r1w, r1h, p2x, p2y, r2w, r2h, &overlap_x, &overlap_y);
+		sweep_start_normal(overlap, overlap_x, overlap_y, (p2x + r2w / 2) - (p1x + r1w / 2), (p2y + r2h / 2) - (p1y + r1h / 2), normal_x, normal_y);
+	}
+	return hit;
+}
+
+// Check for collision between a moving circle and a moving convex polygon
+// poly_verts: x/y pairs (or custom sc2d_v2 structs), relative to (px, py), in either winding
+// The sum of the polygon and the circle is the polygon, each edge pushed out by the radius, and a circle on each vertex.
+bool sc2d_sweep_circle_poly2d(float cx, float cy, float cr, float v1x, float v1y, float px, float py, float* poly_verts, int vert_count,
+							  float v2x, float v2y, float* toi, float* normal_x, float* normal_y) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	float inward = poly2d_inward(&verts);
+	float start_x = cx - px, start_y = cy - py;
+	float delta_x = v1x - v2x, delta_y = v1y - v2y;
+	float max_fraction = 1.0f;
+	bool hit = false;
+
+	if (ray_poly(start_x, start_y, delta_x, delta_y, max_fraction, &verts, 0, inward, toi, normal_x, normal_y)) {
+		hit = true;
+		max_fraction = *toi;
+	}
+
+	for (int i = 0; i < vert_count; i++) {
+		int next = (i + 1 < vert_count) ? i + 1 : 0;
+		float v1_x = vert_x(&verts, i), v1_y = vert_y(&verts, i);
+		float v2_x = vert_x(&verts, next), v2_y = vert_y(&verts, next);
+
+		if (ray_circle(start_x, start_y, delta_x, delta_y, max_fraction, v1_x, v1_y, cr, toi, normal_x, normal_y)) {
+			hit = true;
+			max_fraction = *toi;
+		}
+
+		// The band between the edge and the edge pushed out by the radius
+		float out_x, out_y;
+		get_poly2d_edge(&verts, i, &out_x, &out_y);
+		v2_normal(&out_x, &out_y, false);
+		float length = sc2d_sqrtf(out_x * out_x + out_y * out_y);
+		if (length == 0) continue;
+
+		float scale = -inward * cr / length;
+		out_x *= scale;
+		out_y *= scale;
+
+		float band[8] = {v1_x, v1_y, v2_x, v2_y, v2_x + out_x, v2_y + out_y, v1_x + out_x, v1_y + out_y};
+		sc2d_verts band_verts = packed_view(band, 4);
+		if (ray_poly(start_x, start_y, delta_x, delta_y, max_fraction, &band_verts, 0, -inward, toi, normal_x, normal_y)) {
+			hit = true;
+			max_fraction = *toi;
+		}
+	}
+
+	if (sweep_result(hit, normal_x, normal_y) && *toi == 0) {
+		float overlap_x = 0, overlap_y = 0;
+		bool overlap = sc2d_check_circle_poly2d(cx, cy, cr, px, py, poly_verts, vert_count, &overlap_x, &overlap_y);
+		sweep_start_normal(overlap, overlap_x, overlap_y, px - cx, py - cy, normal_x, normal_y);
+	}
+	return hit;
+}
+
+// Contact manifolds
+// Box2D style clipping: the reference edge is the edge of either polygon with the largest separation, the incident edge
+// is the edge of the other polygon facing it most directly. The incident edge is clipped to the sides of the reference
+// edge and the clipped points behind the reference edge become the contacts.
+
+// The reference edge is on the first polygon unless the second polygon's best edge separates more by this much
+// (world units). Preferring one side keeps the feature ids from flipping between frames on resting contacts.
+#ifndef SC2D_MANIFOLD_TOLERANCE
+#define SC2D_MANIFOLD_TOLERANCE 0.005f
+#endif
+
+static inline unsigned int feature_id(int edge, int vertex, unsigned int flags) {
+	return ((unsigned int)edge & 0x3fffu) | (((unsigned int)vertex & 0x3fffu) << 14) | flags;
+}
+
+// Outward unit normal of edge i. normals: unit left normals of the edges (or NULL to compute them), inward: their sign
+static inline void edge_outward_normal(sc2d_verts* verts, float* normals, float inward, int i, float* normal_x, float* normal_y) {
+	if (normals) {
+		*normal_x = normals[i * 2];
+		*normal_y = normals[i * 2 + 1];
+	} else {
+		get_poly2d_edge(verts, i, normal_x, normal_y);
+		v2_normal(normal_x, normal_y, false);
+		v2_normalize(normal_x, normal_y);
+	}
+
+	*normal_x *= -inward;
+	*normal_y *= -inward;
+}
+
+// Distance of the second polygon (offset by its position relative to the first) in front of edge i of the first
+static float edge_separation(sc2d_verts* p1, float* normals, float inward, int i, sc2d_verts* p2, float offset_x, float offset_y) {
+	float normal_x, normal_y;
+	float min = INFINITY;
+	SC2D_COUNT_ADD(sat_axes, 1);
+	SC2D_COUNT_ADD(projected_verts, p2->count);
+
+	edge_outward_normal(p1, normals, inward, i, &normal_x, &normal_y);
+	offset_x -= vert_x(p1, i);
+	offset_y -= vert_y(p1, i);
+
+	for (int j = 0; j < p2->count; j++) {
+		float distance = normal_x * (vert_x(p2, j) + offset_x) + normal_y * (vert_y(p2, j) + offset_y);
+		min = (distance < min) ? distance : min;
+	}
+
+	return min;
+}
+
+// Edge of the first polygon with the largest separation. Stops at the first edge that separates the polygons.
+static float max_edge_separation(sc2d_verts* p1, float* normals, float inward, sc2d_verts* p2, float offset_x, float offset_y, int* edge) {
+	float max = -INFINITY;
+
+	for (int i = 0; i < p1->count; i++) {
+		float separation = edge_separation(p1, normals, inward, i, p2, offset_x, offset_y);
+
+		if (separation > max) {
+			max = separation;
+			*edge = i;
+			if (separation > 0) break;
+		}
+	}
+
+	return max;
+}
+
+// Keep the part of the segment (points and their ids) with side_x * x + side_y * y <= limit
+// A clipped point replaces the incident vertex that was outside, and keeps its id with SC2D_FEATURE_CLIPPED set.
+static bool clip_segment(float* points, unsigned int* ids, float side_x, float side_y, float limit) {
+	float distance0 = side_x * points[0] + side_y * points[1] - limit;
+	float distance1 = side_x * points[2] + side_y * points[3] - limit;
+
+	if (distance0 > 0 && distance1 > 0) return false;
+	if (distance0 <= 0 && distance1 <= 0) return true;
+
+	int outside = (distance0 > 0) ? 0 : 1;
+	float t = distance0 / (distance0 - distance1);
+	points[outside * 2] = points[0] + t * (points[2] - points[0]);
+	points[outside * 2 + 1] = points[1] + t * (points[3] - points[1]);
+	ids[outside] |= SC2D_FEATURE_CLIPPED;
+
+	return true;
+}
+
+// Store new contacts, carrying the impulses of the previous contacts with the same ids
+static void manifold_store(sc2d_manifold* manifold, float normal_x, float normal_y, sc2d_contact* contacts, int count) {
+	for (int i = 0; i < count; i++) {
+		contacts[i].normal_impulse = 0;
+		contacts[i].tangent_impulse = 0;
+
+		for (int j = 0; j < manifold->count; j++) {
+			if (manifold->contacts[j].id == contacts[i].id) {
+				contacts[i].normal_impulse = manifold->contacts[j].normal_impulse;
+				contacts[i].tangent_impulse = manifold->contacts[j].tangent_impulse;
+				break;
+			}
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		manifold->contacts[i] = contacts[i];
+	}
+
+	manifold->normal_x = normal_x;
+	manifold->normal_y = normal_y;
+	manifold->count = count;
+}
+
+// Manifold of two convex polygons: vertex views, edge normals (or NULL) and the sign that turns those normals inward
+static bool poly2d_manifold(float p1x, float p1y, sc2d_verts* p1, float* normals1, float inward1,
+							float p2x, float p2y, sc2d_verts* p2, float* normals2, float inward2, sc2d_manifold* manifold) {
+	float delta_x = p2x - p1x, delta_y = p2y - p1y;
+	sc2d_sat_cache* cache = &manifold->cache;
+	int edge1 = 0, edge2 = 0;
+
+	// The last separating edge usually still separates the pair
+	if (cache->poly) {
+		bool first = (cache->poly == 1);
+		sc2d_verts* axis_verts = first ? p1 : p2;
+
+		if (cache->edge < axis_verts->count &&
+			edge_separation(axis_verts, first ? normals1 : normals2, first ? inward1 : inward2, cache->edge,
+							first ? p2 : p1, first ? delta_x : -delta_x, first ? delta_y : -delta_y) > 0) {
+			manifold->count = 0;
+			return false;
+		}
+	}
+
+	float separation1 = max_edge_separation(p1, normals1, inward1, p2, delta_x, delta_y, &edge1);
+	if (separation1 > 0) {
+		cache->poly = 1;
+		cache->edge = (unsigned short)edge1;
+		manifold->count = 0;
+		return false;
+	}
+
+	float separation2 = max_edge_separation(p2, normals2, inward2, p1, -delta_x, -delta_y, &edge2);
+	if (separation2 > 0) {
+		cache->poly = 2;
+		cache->edge = (unsigned short)edge2;
+		manifold->count = 0;
+		return false;
+	}
+
+	cache->poly = 0;
+
+	// Reference and incident polygon, with the incident polygon's position relative to the reference polygon
+	bool flip = separation2 > separation1 + SC2D_MANIFOLD_TOLERANCE;
+	sc2d_verts* ref = flip ? p2 : p1;
+	sc2d_verts* inc = flip ? p1 : p2;
+	float* inc_normals = flip ? normals1 : normals2;
+	float inc_inward = flip ? inward1 : inward2;
+	int edge = flip ? edge2 : edge1;
+	float offset_x = flip ? -delta_x : delta_x, offset_y = flip ? -delta_y : delta_y;
+
+	float normal_x, normal_y;
+	edge_outward_normal(ref, flip ? normals2 : normals1, flip ? inward2 : inward1, edge, &normal_x, &normal_y);
+
+	// Incident edge: the edge whose normal is most opposite to the reference normal
+	int incident = 0;
+	float min_dot = INFINITY;
+	for (int i = 0; i < inc->count; i++) {
+		float inc_x, inc_y;
+		edge_outward_normal(inc, inc_normals, inc_inward, i, &inc_x, &inc_y);
+
+		float dot = normal_x * inc_x + normal_y * inc_y;
+		if (dot < min_dot) {
+			min_dot = dot;
+			incident = i;
+		}
+	}
+
+	int incident_next = (incident + 1 < inc->count) ? incident + 1 : 0;
+	unsigned int flags = flip ? SC2D_FEATURE_FLIP : 0;
+	float points[4] = {
+		vert_x(inc, incident) + offset_x, vert_y(inc, incident) + offset_y,
+		vert_x(inc, incident_next) + offset_x, vert_y(inc, incident_next) + offset_y
+	};
+	unsigned int ids[2] = {feature_id(edge, incident, flags), feature_id(edge, incident_next, flags)};
+
+	// Clip the incident edge to the sides of the reference edge
+	int edge_next = (edge + 1 < ref->count) ? edge + 1 : 0;
+	float ref1_x = vert_x(ref, edge), ref1_y = vert_y(ref, edge);
+	float tangent_x = vert_x(ref, edge_next) - ref1_x, tangent_y = vert_y(ref, edge_next) - ref1_y;
+	float lower = tangent_x * ref1_x + tangent_y * ref1_y;
+	float upper = tangent_x * vert_x(ref, edge_next) + tangent_y * vert_y(ref, edge_next);
+
+	sc2d_contact contacts[2];
+	int count = 0;
+
+	if (clip_segment(points, ids, -tangent_x, -tangent_y, -lower) && clip_segment(points, ids, tangent_x, tangent_y, upper)) {
+		for (int i = 0; i < 2; i++) {
+			float separation = normal_x * (points[i * 2] - ref1_x) + normal_y * (points[i * 2 + 1] - ref1_y);
+			if (separation > 0) continue;
+
+			contacts[count].x = points[i * 2] - normal_x * separation * 0.5f;
+			contacts[count].y = points[i * 2 + 1] - normal_y * separation * 0.5f;
+			contacts[count].depth = -separation;
+			contacts[count].id = ids[i];
+			count++;
+		}
+	}
+
+	// Corner contacts the clipping misses: use the deepest incident vertex
+	if (count == 0) {
+		int deepest = 0;
+		float min_separation = INFINITY;
+
+		for (int i = 0; i < inc->count; i++) {
+			float separation = normal_x * (vert_x(inc, i) + offset_x - ref1_x) + normal_y * (vert_y(inc, i) + offset_y - ref1_y);
+			if (separation < min_separation) {
+				min_separation = separation;
+				deepest = i;
+			}
+		}
+
+		contacts[0].x = vert_x(inc, deepest) + offset_x - normal_x * min_separation * 0.5f;
+		contacts[0].y = vert_y(inc, deepest) + offset_y - normal_y * min_separation * 0.5f;
+		contacts[0].depth = -min_separation;
+		contacts[0].id = feature_id(edge, deepest, flags);
+		count = 1;
+	}
+
+	// To world space, with the normal pointing from the first polygon toward the second
+	float ref_x = flip ? p2x : p1x, ref_y = flip ? p2y : p1y;
+	for (int i = 0; i < count; i++) {
+		contacts[i].x += ref_x;
+		contacts[i].y += ref_y;
+	}
+
+	manifold_store(manifold, flip ? -normal_x : normal_x, flip ? -normal_y : normal_y, contacts, count);
+	return true;
+}
+
+// Contact manifold of two convex polygons: up to two contacts with depths and feature ids
+// manifold: caller-owned and zero initialized, kept per pair between frames. Contacts whose feature ids match the
+// previous call keep their solver impulses, so the solver can start from last frame's solution.
+// Returns false and clears the contacts when the polygons do not overlap.
+bool sc2d_manifold_poly2d(	float p1x, float p1y, float* p1_verts, int p1_count,
+							float p2x, float p2y, float* p2_verts, int p2_count,
+							sc2d_manifold* manifold) {
+	sc2d_verts p1 = v2_view(p1_verts, p1_count);
+	sc2d_verts p2 = v2_view(p2_verts, p2_count);
+
+	return SC2D_COUNT_CALL(SC2D_STAT_MANIFOLD_POLY2D,
+						   poly2d_manifold(p1x, p1y, &p1, 0, poly2d_inward(&p1), p2x, p2y, &p2, 0, poly2d_inward(&p2), manifold));
+}
+
+// Same as sc2d_manifold_poly2d, using the precomputed normals of two sc2d_polys
+bool sc2d_manifold_polys(float p1x, float p1y, sc2d_poly* p1, float p2x, float p2y, sc2d_poly* p2, sc2d_manifold* manifold) {
+	if (bounds_apart(p2x - p1x, p2y - p1y, p1->radius + p2->radius)) {
+		manifold->count = 0;
+		return SC2D_COUNT_CALL(SC2D_STAT_MANIFOLD_POLY2D, false);
+	}
+
+	sc2d_verts v1 = packed_view(p1->verts, p1->count);
+	sc2d_verts v2 = packed_view(p2->verts, p2->count);
+
+	return SC2D_COUNT_CALL(SC2D_STAT_MANIFOLD_POLY2D,
+						   poly2d_manifold(p1x, p1y, &v1, p1->normals, poly_inward(p1), p2x, p2y, &v2, p2->normals, poly_inward(p2), manifold));
+}
+
+// A circle touches a polygon at one point: its closest edge, or its closest vertex as a corner feature
+static bool circle_poly_manifold(float cx, float cy, float cr, float px, float py, sc2d_verts* verts, sc2d_manifold* manifold) {
+	float overlap_x, overlap_y;
+	sc2d_contact contact;
+
+	if (!circle_poly_overlap(cx - px, cy - py, cr, verts, &overlap_x, &overlap_y, &contact.id)) {
+		manifold->count = 0;
+		return false;
+	}
+
+	float depth = sc2d_hypotf(overlap_x, overlap_y);
+	float normal_x, normal_y;
+
+	if (depth > SC2D_LINE_EPSILON) {
+		normal_x = overlap_x / depth;
+		normal_y = overlap_y / depth;
+	} else { // Touching without depth: use the inward normal of the closest edge (the edge after a closest vertex)
+		int edge = (contact.id & SC2D_FEATURE_CORNER) ? (int)((contact.id >> 14) & 0x3fffu) : (int)contact.id;
+		edge_outward_normal(verts, 0, poly2d_inward(verts), edge, &normal_x, &normal_y);
+		normal_x = -normal_x;
+		normal_y = -normal_y;
+	}
+
+	// The polygon's surface is depth - radius behind the center along the normal, the circle's is radius in front of it
+	contact.x = cx + normal_x * (cr - depth * 0.5f);
+	contact.y = cy + normal_y * (cr - depth * 0.5f);
+	contact.depth = depth;
+
+	manifold_store(manifold, normal_x, normal_y, &contact, 1);
+	return true;
+}
+
+// Contact manifold of a circle and a convex polygon: one contact, with the normal from the circle toward the polygon
+// manifold: caller-owned and zero initialized, kept per pair between frames (see sc2d_manifold_poly2d)
+bool sc2d_manifold_circle_poly2d(float cx, float cy, float cr, float px, float py, float* poly_verts, int vert_count, sc2d_manifold* manifold) {
+	sc2d_verts verts = v2_view(poly_verts, vert_count);
+	return SC2D_COUNT_CALL(SC2D_STAT_MANIFOLD_CIRCLE_POLY2D, circle_poly_manifold(cx, cy, cr, px, py, &verts, manifold));
+}
+
+// Same as sc2d_manifold_circle_poly2d for an sc2d_poly
+bool sc2d_manifold_circle_poly(float cx, float cy, float cr, float x, float y, sc2d_poly* poly, sc2d_manifold* manifold) {
+	sc2d_verts verts = packed_view(poly->verts, poly->count);
+	return SC2D_COUNT_CALL(SC2D_STAT_MANIFOLD_CIRCLE_POLY2D, circle_poly_manifold(cx, cy, cr, x, y, &verts, manifold));
+}
+
+// Columns per pass over a tilemap, so that a row of cells plus its two neighbors fits one 64-bit mask
+#define TILE_CHUNK 62
+
+// Solid cells count (up to 64) from column x of row y, one bit per cell with the lowest bit first. Cells outside the map are empty.
+static unsigned long long tile_row(sc2d_tilemap* map, int x, int y, int count) {
+	int first = (x > 0) ? x : 0, last = ((x + count < map->width) ? x + count : map->width) - 1;
+	if (y < 0 || y >= map->height || first > last) return 0;
+
+	unsigned char* row = map->cells + (ptrdiff_t)y * map->stride;
+	unsigned long long bits = 0;
+
+	if (map->bits) {
+		for (int i = first >> 3; i <= last >> 3; i++) {
+			int shift = i * 8 - x;
+			bits |= (shift < 0) ? (unsigned long long)row[i] >> -shift : (unsigned long long)row[i] << shift;
+		}
+	} else {
+		// Eight cells per load while the row has room for them: the top bit of each byte is set if any bit is, then the
+		// top bits are gathered into the low byte with one multiply
+		int i = first;
+		for (; i <= last && i + 8 <= map->width; i += 8) {
+			unsigned char* p = row + i;
+			unsigned long long word = (unsigned long long)p[0] | (unsigned long long)p[1] << 8 | (unsigned long long)p[2] << 16 |
+									  (unsigned long long)p[3] << 24 | (unsigned long long)p[4] << 32 | (unsigned long long)p[5] << 40 |
+									  (unsigned long long)p[6] << 48 | (unsigned long long)p[7] << 56;
+			word = (((word & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | word) & 0x8080808080808080ull;
+			bits |= (((word >> 7) * 0x0102040810204080ull) >> 56) << (i - x);
+		}
+		for (; i <= last; i++) bits |= (unsigned long long)(row[i] != 0) << (i - x);
+	}
+	// Drop the bits read past the columns or the map
+	return bits & (~0ull >> (63 - (last - x))) & (~0ull << (first - x));
+}
+
+// Cells covered by a box, clamped to the map. Returns false if the box misses the map.
+static bool tile_range(sc2d_tilemap* map, float min_x, float min_y, float max_x, float max_y, int* x0, int* y0, int* x1, int* y1) {
+	float inv_size = 1.0f / map->cell_size;
+	float cell_x0 = (min_x - map->x) * inv_size, cell_y0 = (min_y - map->y) * inv_size;
+	float cell_x1 = (max_x - map->x) * inv_size, cell_y1 = (max_y - map->y) * inv_size;
+
+	// Clamp as floats, so boxes far outside the map don't overflow the conversion. What's left is positive, where truncating is flooring.
+	if (cell_x1 < 0 || cell_y1 < 0 || cell_x0 >= map->width || cell_y0 >= map->height) return false;
+	*x0 = (cell_x0 > 0) ? (int)cell_x0 : 0;
+	*y0 = (cell_y0 > 0) ? (int)cell_y0 : 0;
+	*x1 = (cell_x1 < map->width) ? (int)cell_x1 : map->width - 1;
+	*y1 = (cell_y1 < map->height) ? (int)cell_y1 : map->height - 1;
+	return true;
+}
+
+// Keep the shortest way out of a cell. Only faces that border an empty cell count, so a run of solid cells acts
+// like one box and shapes sliding along it don't catch on the seams between cells.
+static inline void tile_face(bool open, float depth, float dir_x, float dir_y, float* best, float* overlap_x, float* overlap_y) {
+	if (open && (*best < 0 || depth < *best)) {
+		*best = depth;
+		*overlap_x = dir_x * depth;
+		*overlap_y = dir_y * depth;
+	}
+}
+
+// Combine the overlaps of several cells: the largest in each direction, so cells pushing the same way don't add up
+static inline void tile_combine(float* limits, float overlap_x, float overlap_y) {
+	limits[0] = (overlap_x < limits[0]) ? overlap_x : limits[0];
+	limits[1] = (overlap_y < limits[1]) ? overlap_y : limits[1];
+	limits[2] = (overlap_x > limits[2]) ? overlap_x : limits[2];
+	limits[3] = (overlap_y > limits[3]) ? overlap_y : limits[3];
+}
+
+// Check for collision between a rectangle (left x, top y, width, height) and the solid cells of a tilemap
+// Only the covered cells and their neighbors are read, a row at a time. Each solid cell is left through its nearest face that borders an
+// empty cell, and the cells are combined into one overlap that can have both an x and a y part (floor and wall at once).
+// Faces on the far side of a cell from the rectangle's center are skipped, like sc2d_check_circle_tilemap does, so a cell whose
+// near faces are all shared with solid neighbors (the inner corner of a floor and a wall) is left to those neighbors.
+// A rectangle buried in solid cells with no open face among them hits with a zero overlap.
+bool sc2d_check_rect_tilemap(float rx, float ry, float rw, float rh, sc2d_tilemap* map, float* overlap_x, float* overlap_y) {
+	float limits[4] = {0, 0, 0, 0};
+	float size = map->cell_size;
+	float center_x = rx + rw * 0.5f, center_y = ry + rh * 0.5f;
+	int x0, y0, x1, y1;
+	bool result = false;
+
+	if (tile_range(map, rx, ry, rx + rw, ry + rh, &x0, &y0, &x1, &y1)) {
+		for (int chunk_x = x0; chunk_x <= x1; chunk_x += TILE_CHUNK) {
+			int count = (x1 - chunk_x + 1 < TILE_CHUNK) ? x1 - chunk_x + 1 : TILE_CHUNK;
+			unsigned long long covered = 0;
+
+			// Bit i is column chunk_x - 1 + i, so bits 1 to count are the covered columns and the others their neighbors
+			for (int i = 1; i <= count; i++) {
+				float left = map->x + (chunk_x - 1 + i) * size;
+				if (rx + rw > left && left + size > rx) covered |= 1ull << i;
+			}
+
+			// The rows just outside the covered ones are only read when a solid cell next to them has a face toward the center
+			// there. Unread rows count as solid, which closes faces that are skipped anyway.
+			unsigned long long row = tile_row(map, chunk_x - 1, y0, count + 2);
+			bool above_needed = (row & covered) && center_y < map->y + (y0 + 1) * size;
+			unsigned long long above = above_needed ? tile_row(map, chunk_x - 1, y0 - 1, count + 2) : ~0ull;
+
+			for (int ty = y0; ty <= y1; ty++) {
+				unsigned long long solid = row & covered;
+				float top = map->y + ty * size, bottom = top + size;
+				bool below_needed = ty < y1 || (solid && center_y > top);
+				unsigned long long below = below_needed ? tile_row(map, chunk_x - 1, ty + 1, count + 2) : ~0ull;
+
+				if (solid && ry + rh > top && bottom > ry) {
+					// Cells with solid neighbors on all sides can't be left and add nothing but the hit
+					unsigned long long open = solid & ~((row << 1) & (row >> 1) & above & below);
+					result = true;
+
+					for (int i = 1; open >> i; i++) {
+						if (!((open >> i) & 1)) continue;
+
+						float left = map->x + (chunk_x - 1 + i) * size, right = left + size;
+						float best = -1, cell_x = 0, cell_y = 0;
+						tile_face(center_x < right && !((row >> (i - 1)) & 1), rx + rw - left, 1, 0, &best, &cell_x, &cell_y);
+						tile_face(center_x > left && !((row >> (i + 1)) & 1), right - rx, -1, 0, &best, &cell_x, &cell_y);
+						tile_face(center_y < bottom && !((above >> i) & 1), ry + rh - top, 0, 1, &best, &cell_x, &cell_y);
+						tile_face(center_y > top && !((below >> i) & 1), bottom - ry, 0, -1, &best, &cell_x, &cell_y);
+
+						tile_combine(limits, cell_x, cell_y);
+					}
+				}
+
+				above = row;
+				row = below;
+			}
+		}
+	}
+
+	if (result) {
+		*overlap_x = limits[0] + limits[2];
+		*overlap_y = limits[1] + limits[3];
+	}
+	return SC2D_COUNT_CALL(SC2D_STAT_RECT_TILEMAP, result);
+}
+
+// Check for collision between a circle and the solid cells of a tilemap, like sc2d_check_rect_tilemap
+// A cell whose nearest face or corner is shared with a solid neighbor is left to that neighbor, so circles
+// rolling along a run of cells only touch its outline.
+bool sc2d_check_circle_tilemap(float cx, float cy, float cr, sc2d_tilemap* map, float* overlap_x, float* overlap_y) {
+	float limits[4] = {0, 0, 0, 0};
+	float size = map->cell_size;
+	int x0, y0, x1, y1;
+	bool result = false;
+
+	if (tile_range(map, cx - cr, cy - cr, cx + cr, cy + cr, &x0, &y0, &x1, &y1)) {
+		for (int chunk_x = x0; chunk_x <= x1; chunk_x += TILE_CHUNK) {
+			int count = (x1 - chunk_x + 1 < TILE_CHUNK) ? x1 - chunk_x + 1 : TILE_CHUNK;
+			unsigned long long covered = (~0ull >> (63 - count)) & ~1ull;	// Bits 1 to count, as in sc2d_check_rect_tilemap
+
+			// Neighbor rows are read as in sc2d_check_rect_tilemap: only faces toward the center need them
+			unsigned long long row = tile_row(map, chunk_x - 1, y0, count + 2);
+			bool above_needed = (row & covered) && cy <= map->y + (y0 + 1) * size;
+			unsigned long long above = above_needed ? tile_row(map, chunk_x - 1, y0 - 1, count + 2) : ~0ull;
+
+			for (int ty = y0; ty <= y1; ty++) {
+				unsigned long long solid = row & covered;
+				float top = map->y + ty * size, bottom = top + size;
+				bool below_needed = ty < y1 || (solid && cy >= top);
+				unsigned long long below = below_needed ? tile_row(map, chunk_x - 1, ty + 1, count + 2) : ~0ull;
+				float delta_y = sc2d_min(sc2d_max(cy, top), bottom) - cy;
+
+				if (solid && delta_y * delta_y < cr * cr) {
+					unsigned long long buried = (row << 1) & (row >> 1) & above & below;
+
+					for (int i = 1; solid >> i; i++) {
+						// Buried cells add nothing but the hit, which only needs one
+						if (!((solid >> i) & 1) || (result && ((buried >> i) & 1))) continue;
+
+						float left = map->x + (chunk_x - 1 + i) * size, right = left + size;
+						float delta_x = sc2d_min(sc2d_max(cx, left), right) - cx;
+						float distance_sq = delta_x * delta_x + delta_y * delta_y;
+						if (distance_sq >= cr * cr) continue;
+
+						result = true;
+						if ((buried >> i) & 1) continue;
+
+						int side_x = (cx < left) ? -1 : (cx > right) ? 1 : 0;
+						int side_y = (cy < top) ? -1 : (cy > bottom) ? 1 : 0;
+
+						if (side_x != 0 || side_y != 0) {
+							// Center outside the cell: push away from the nearest face or corner
+							if ((side_x != 0 && ((row >> (i + side_x)) & 1)) || (side_y != 0 && (((side_y < 0 ? above : below) >> i) & 1))) continue;
+
+							float distance = sc2d_sqrtf(distance_sq);
+							float depth = cr - distance;
+							tile_combine(limits, delta_x / distance * depth, delta_y / distance * depth);
+						} else {
+							// Center inside the cell: out through the nearest open face
+							float best = -1, cell_x = 0, cell_y = 0;
+							tile_face(!((row >> (i - 1)) & 1), cx - left + cr, 1, 0, &best, &cell_x, &cell_y);
+							tile_face(!((row >> (i + 1)) & 1), right - cx + cr, -1, 0, &best, &cell_x, &cell_y);
+							tile_face(!((above >> i) & 1), cy - top + cr, 0, 1, &best, &cell_x, &cell_y);
+							tile_face(!((below >> i) & 1), bottom - cy + cr, 0, -1, &best, &cell_x, &cell_y);
+
+							tile_combine(limits, cell_x, cell_y);
+						}
+					}
+				}
+
+				above = row;
+				row = below;
+			}
+		}
+	}
+
+	if (result) {
+		*overlap_x = limits[0] + limits[2];
+		*overlap_y = limits[1] + limits[3];
+	}
+	return SC2D_COUNT_CALL(SC2D_STAT_CIRCLE_TILEMAP, result);
+}
+
+#if SC2D_LANES > 1
+// Check for collision between circle pairs in every lane with the same operations, in the same order, as
+// sc2d_check_circles, so the results match it (unless the compiler fuses the scalar multiply-adds).
+// Returns a bitmask of the colliding lanes. Overlaps are only stored if a lane collides.
+static inline int circle_lanes(sc2d_vf x1, sc2d_vf y1, sc2d_vf r1, sc2d_vf x2, sc2d_vf y2, sc2d_vf r2,
+							   float* overlap_x, float* overlap_y) {
+	sc2d_vf dx = SC2D_VF_SUB(x2, x1);
+	sc2d_vf dy = SC2D_VF_SUB(y2, y1);
+	sc2d_vf rs = SC2D_VF_ADD(r1, r2);
+	sc2d_vf d2 = SC2D_VF_ADD(SC2D_VF_MUL(dx, dx), SC2D_VF_MUL(dy, dy));
+
+	int mask = SC2D_VM_BITS(SC2D_VM_LT(d2, SC2D_VF_MUL(rs, rs)));
+	if (!mask) return 0; // Most blocks miss entirely, skip the square root and divides
+
+	sc2d_vf zero = SC2D_VF_SET1(0.0f), one = SC2D_VF_SET1(1.0f);
+	sc2d_vf magnitude = SC2D_VF_SQRT(d2);
+	sc2d_vf depth = SC2D_VF_SUB(rs, magnitude);
+	magnitude = SC2D_VF_SELECT(SC2D_VM_EQ(magnitude, zero), one, magnitude); // Same centers: any direction works, avoid dividing by zero
+
+	SC2D_VF_STORE(overlap_x, SC2D_VF_MUL(SC2D_VF_DIV(dx, magnitude), depth));
+	SC2D_VF_STORE(overlap_y, SC2D_VF_MUL(SC2D_VF_DIV(dy, magnitude), depth));
+	return mask;
+}
+#endif
+
+// Check for collision between circles (x[], y[], r[]) for every index pair and write the colliding pairs to hits
+// hits must have room for pair_count results. Returns the number of hits written.
+int sc2d_check_circles_batch(float* x, float* y, float* r, sc2d_pair* pairs, int pair_count, sc2d_hit* hits) {
+	int hit_count = 0;
+	int i = 0;
+
+#if SC2D_LANES > 1
+	float overlap_x[SC2D_LANES], overlap_y[SC2D_LANES];
+	for (; i + SC2D_LANES <= pair_count; i += SC2D_LANES) {
+		sc2d_pair* block = pairs + i;
+		int mask = circle_lanes(SC2D_VF_GATHER(x, block, a), SC2D_VF_GATHER(y, block, a), SC2D_VF_GATHER(r, block, a),
+								SC2D_VF_GATHER(x, block, b), SC2D_VF_GATHER(y, block, b), SC2D_VF_GATHER(r, block, b), overlap_x, overlap_y);
+
+		// Write every lane and only advance past hits. hit_count <= i + lane, so this stays inside hits.
+		for (int lane = 0; mask && lane < SC2D_LANES; lane++) {
+			sc2d_hit* hit = hits + hit_count;
+			hit->a = block[lane].a;
+			hit->b = block[lane].b;
+			hit->overlap_x = overlap_x[lane];
+			hit->overlap_y = overlap_y[lane];
+			hit_count += (mask >> lane) & 1;
+		}
+	}
+#endif
+
+	for (; i < pair_count; i++) {
+		int a = pairs[i].a, b = pairs[i].b;
+		sc2d_hit* hit = hits + hit_count;
+		hit->a = a;
+		hit->b = b;
+		hit_count += sc2d_check_circles(x[a], y[a], r[a], x[b], y[b], r[b], &hit->overlap_x, &hit->overlap_y);
+	}
+
+	return hit_count;
+}
+
+// Check for collision between one circle (px, py, pr) and count circles (x[], y[], r[])
+// Hits are reported with a = -1 and b = index of the other circle, and the overlap relative to the single circle.
+// hits must have room for count results. Returns the number of hits written.
+int sc2d_check_circle_many(float px, float py, float pr, float* x, float* y, float* r, int count, sc2d_hit* hits) {
+	int hit_count = 0;
+	int i = 0;
+
+#if SC2D_LANES > 1
+	sc2d_vf x1 = SC2D_VF_SET1(px), y1 = SC2D_VF_SET1(py), r1 = SC2D_VF_SET1(pr);
+	float overlap_x[SC2D_LANES], overlap_y[SC2D_LANES];
+	for (; i + SC2D_LANES <= count; i += SC2D_LANES) {
+		int mask = circle_lanes(x1, y1, r1, SC2D_VF_LOAD(x + i), SC2D_VF_LOAD(y + i), SC2D_VF_LOAD(r + i), overlap_x, overlap_y);
+
+		for (int lane = 0; mask; lane++, mask >>= 1) {
+			if (mask & 1) {
+				sc2d_hit* hit = hits + hit_count++;
+				hit->a = -1;
+				hit->b = i + lane;
+				hit->overlap_x = overlap_x[lane];
+				hit->overlap_y = overlap_y[lane];
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++) {
+		sc2d_hit* hit = hits + hit_count;
+		hit->a = -1;
+		hit->b = i;
+		hit_count += sc2d_check_circles(px, py, pr, x[i], y[i], r[i], &hit->overlap_x, &hit->overlap_y);
+	}
+
+	return hit_count;
+}
+
+#if SC2D_LANES > 1
+// Check for collision between rectangle pairs in every lane with the same rules as sc2d_check_rects
+// Overlaps of lanes that do not collide are set to zero. Returns a bitmask of the colliding lanes.
+static inline int rect_lanes(sc2d_vf p1x, sc2d_vf p1y, sc2d_vf r1w, sc2d_vf r1h,
+							 sc2d_vf p2x, sc2d_vf p2y, sc2d_vf r2w, sc2d_vf r2h,
+							 float* overlap_x, float* overlap_y) {
+	sc2d_vf zero = SC2D_VF_SET1(0.0f), one = SC2D_VF_SET1(1.0f);
+
+	// Overlap from whichever rect starts first, without branching
+	sc2d_vf ox = SC2D_VF_SELECT(SC2D_VM_LT(p1x, p2x), SC2D_VF_SUB(SC2D_VF_ADD(p1x, r1w), p2x), SC2D_VF_SUB(SC2D_VF_ADD(p2x, r2w), p1x));
+	sc2d_vf oy = SC2D_VF_SELECT(SC2D_VM_LT(p1y, p2y), SC2D_VF_SUB(SC2D_VF_ADD(p1y, r1h), p2y), SC2D_VF_SUB(SC2D_VF_ADD(p2y, r2h), p1y));
+	sc2d_vm hit = SC2D_VM_AND(SC2D_VM_LT(zero, ox), SC2D_VM_LT(zero, oy));
+
+	// Point the overlap from the first rect toward the second
+	ox = SC2D_VF_SELECT(SC2D_VM_LT(p2x, p1x), SC2D_VF_SUB(zero, ox), ox);
+	oy = SC2D_VF_SELECT(SC2D_VM_LT(p2y, p1y), SC2D_VF_SUB(zero, oy), oy);
+
+	// Keep only the shortest axis (multiplied rather than masked to keep the signed zeros of the scalar version)
+	ox = SC2D_VF_MUL(ox, SC2D_VF_SELECT(SC2D_VM_LT(SC2D_VF_ABS(ox), SC2D_VF_ABS(oy)), one, zero));
+	oy = SC2D_VF_MUL(oy, SC2D_VF_SELECT(SC2D_VM_EQ(ox, zero), one, zero));
+
+	SC2D_VF_STORE(overlap_x, SC2D_VF_SELECT(hit, ox, zero));
+	SC2D_VF_STORE(overlap_y, SC2D_VF_SELECT(hit, oy, zero));
+
+	return SC2D_VM_BITS(hit);
+}
+#endif
+
+// Check for collision between rectangles (left x[], top y[], width w[], height h[]) for every index pair
+// hit_mask[i] is set to 1 if pairs[i] collide, else 0, and overlap_x[i]/overlap_y[i] are set to the overlap
+// relative to rect a (zero for pairs that do not collide). Returns the number of colliding pairs.
+int sc2d_check_rects_batch(float* x, float* y, float* w, float* h, sc2d_pair* pairs, int pair_count,
+						   unsigned char* hit_mask, float* overlap_x, float* overlap_y) {
+	int hit_count = 0;
+	int i = 0;
+
+#if SC2D_LANES > 1
+	for (; i + SC2D_LANES <= pair_count; i += SC2D_LANES) {
+		sc2d_pair* block = pairs + i;
+		int mask = rect_lanes(SC2D_VF_GATHER(x, block, a), SC2D_VF_GATHER(y, block, a), SC2D_VF_GATHER(w, block, a), SC2D_VF_GATHER(h, block, a),
+							  SC2D_VF_GATHER(x, block, b), SC2D_VF_GATHER(y, block, b), SC2D_VF_GATHER(w, block, b), SC2D_VF_GATHER(h, block, b),
+							  overlap_x + i, overlap_y + i);
+
+		for (int lane = 0; lane < SC2D_LANES; lane++, mask >>= 1) {
+			hit_mask[i + lane] = (unsigned char)(mask & 1);
+			hit_count += mask & 1;
+		}
+	}
+#endif
+
+	for (; i < pair_count; i++) {
+		int a = pairs[i].a, b = pairs[i].b;
+		bool hit = sc2d_check_rects(x[a], y[a], w[a], h[a], x[b], y[b], w[b], h[b], overlap_x + i, overlap_y + i);
+
+		if (!hit) overlap_x[i] = overlap_y[i] = 0;
+		hit_mask[i] = (unsigned char)hit;
+		hit_count += hit;
+	}
+
+	return hit_count;
+}
+
+// Hash a grid cell to a bucket
+static inline int grid_bucket(sc2d_grid* grid, int cell_x, int cell_y) {
+	unsigned int hash = ((unsigned int)cell_x * 73856093u) ^ ((unsigned int)cell_y * 19349663u);
+	return (int)(hash & (unsigned int)(grid->bucket_count - 1));
+}
+
+// Get the range of cells covered by a rectangle (left x, top y, width, height)
+static inline void grid_cells(sc2d_grid* grid, float x, float y, float w, float h, int* min_x, int* min_y, int* max_x, int* max_y) {
+	*min_x = (int)sc2d_floorf(x * grid->inv_cell_size);
+	*min_y = (int)sc2d_floorf(y * grid->inv_cell_size);
+	*max_x = (int)sc2d_floorf((x + w) * grid->inv_cell_size);
+	*max_y = (int)sc2d_floorf((y + h) * grid->inv_cell_size);
+}
+
+// Check if two rectangles (left x, top y, width, height) overlap or touch
+static inline bool rects_touch(float x1, float y1, float w1, float h1, float x2, float y2, float w2, float h2) {
+	return x1 <= x2 + w2 && x2 <= x1 + w1 && y1 <= y2 + h2 && y2 <= y1 + h1;
+}
+
+// Set up a grid using caller-owned memory
+// buckets: bucket_count + 1 ints. bucket_count must be a power of two, about the number of objects works well
+// entries: room for one entry per object per cell it overlaps
+// cell_size should be about the size of a typical object
+void sc2d_grid_init(sc2d_grid* grid, float cell_size, int* buckets, int bucket_count, sc2d_grid_entry* entries, int entry_capacity) {
+	grid->cell_size = cell_size;
+	grid->inv_cell_size = 1.0f / cell_size;
+	grid->buckets = buckets;
+	grid->bucket_count = bucket_count;
+	grid->entries = entries;
+	grid->entry_capacity = entry_capacity;
+	grid->entry_count = 0;
+
+	for (int i = 0; i <= bucket_count; i++) buckets[i] = 0;
+}
+
+// Insert count rectangles (left x[], top y[], width w[], height h[]) into the grid, replacing its previous contents
+// Objects are identified by their array index. Returns false (and leaves the grid empty) if entries is too small.
+bool sc2d_grid_build(sc2d_grid* grid, float* x, float* y, float* w, float* h, int count) {
+	int* buckets = grid->buckets;
+	int min_x, min_y, max_x, max_y;
+	int total = 0;
+
+	for (int i = 0; i <= grid->bucket_count; i++) buckets[i] = 0;
+	grid->entry_count = 0;
+
+	// Count the entries in each bucket
+	for (int i = 0; i < count; i++) {
+		grid_cells(grid, x[i], y[i], w[i], h[i], &min_x, &min_y, &max_x, &max_y);
+		for (int cy = min_y; cy <= max_y; cy++) {
+			for (int cx = min_x; cx <= max_x; cx++) {
+				buckets[grid_bucket(grid, cx, cy)]++;
+			}
+		}
+		total += (max_x - min_x + 1) * (max_y - min_y + 1);
+	}
+
+	if (total > grid->entry_capacity) {
+		for (int i = 0; i <= grid->bucket_count; i++) buckets[i] = 0;
+		return false;
+	}
+
+	// Turn the counts into bucket end offsets
+	for (int i = 0, sum = 0; i <= grid->bucket_count; i++) {
+		sum += buckets[i];
+		buckets[i] = sum;
+	}
+
+	// Fill each bucket from the back, which leaves every offset at the start of its bucket
+	for (int i = 0; i < count; i++) {
+		grid_cells(grid, x[i], y[i], w[i], h[i], &min_x, &min_y, &max_x, &max_y);
+		for (int cy = min_y; cy <= max_y; cy++) {
+			for (int cx = min_x; cx <= max_x; cx++) {
+				sc2d_grid_entry* entry = grid->entries + (--buckets[grid_bucket(grid, cx, cy)]);
+				entry->id = i;
+				entry->cell_x = cx;
+				entry->cell_y = cy;
+			}
+		}
+	}
+
+	grid->entry_count = total;
+	return true;
+}
+
+// Find every pair of overlapping rectangles in the grid. x/y/w/h must be the arrays the grid was built from.
+// Each pair is reported once, with a < b, from the first cell the two rectangles share.
+// Returns the number of pairs found, which may be more than pair_capacity (only pair_capacity pairs are written).
+int sc2d_grid_pairs(sc2d_grid* grid, float* x, float* y, float* w, float* h, sc2d_pair* pairs, int pair_capacity) {
+	int pair_count = 0;
+
+	for (int bucket = 0; bucket < grid->bucket_count; bucket++) {
+		sc2d_grid_entry* start = grid->entries + grid->buckets[bucket];
+		sc2d_grid_entry* end = grid->entries + grid->buckets[bucket + 1];
+
+		for (sc2d_grid_entry* e1 = start; e1 < end; e1++) {
+			for (sc2d_grid_entry* e2 = e1 + 1; e2 < end; e2++) {
+				// Different cells can hash to the same bucket
+				if (e1->cell_x != e2->cell_x || e1->cell_y != e2->cell_y) continue;
+
+				int a = e1->id, b = e2->id;
+				if (!rects_touch(x[a], y[a], w[a], h[a], x[b], y[b], w[b], h[b])) continue;
+
+				// Only report the pair from the top left cell that both rectangles cover
+				int first_x = (int)sc2d_floorf(sc2d_max(x[a], x[b]) * grid->inv_cell_size);
+				int first_y = (int)sc2d_floorf(sc2d_max(y[a], y[b]) * grid->inv_cell_size);
+				if (e1->cell_x != first_x || e1->cell_y != first_y) continue;
+
+				if (pair_count < pair_capacity) {
+					pairs[pair_count].a = (a < b) ? a : b;
+					pairs[pair_count].b = (a < b) ? b : a;
+				}
+				pair_count++;
+			}
+		}
+	}
+
+	return pair_count;
+}
+
+// Find every rectangle in the grid that overlaps the query rectangle (qx, qy, qw, qh)
+// x/y/w/h must be the arrays the grid was built from. Each index is reported once.
+// Returns the number of results found, which may be more than result_capacity (only result_capacity are written).
+int sc2d_grid_query(sc2d_grid* grid, float* x, float* y, float* w, float* h,
+					float qx, float qy, float qw, float qh, int* results, int result_capacity) {
+	int result_count = 0;
+	int min_x, min_y, max_x, max_y;
+
+	grid_cells(grid, qx, qy, qw, qh, &min_x, &min_y, &max_x, &max_y);
+	for (int cy = min_y; cy <= max_y; cy++) {
+		for (int cx = min_x; cx <= max_x; cx++) {
+			int bucket = grid_bucket(grid, cx, cy);
+			sc2d_grid_entry* end = grid->entries + grid->buckets[bucket + 1];
+
+			for (sc2d_grid_entry* entry = grid->entries + grid->buckets[bucket]; entry < end; entry++) {
+				if (entry->cell_x != cx || entry->cell_y != cy) continue;
+
+				int id = entry->id;
+				if (!rects_touch(qx, qy, qw, qh, x[id], y[id], w[id], h[id])) continue;
+
+				// Only report the object from the first cell it shares with the query
+				int first_x = (int)sc2d_floorf(sc2d_max(qx, x[id]) * grid->inv_cell_size);
+				int first_y = (int)sc2d_floorf(sc2d_max(qy, y[id]) * grid->inv_cell_size);
+				if (cx != first_x || cy != first_y) continue;
+
+				if (result_count < result_capacity) results[result_count] = id;
+				result_count++;
+			}
+		}
+	}
+
+	return result_count;
+}
+
+// Sort order of sweep and prune endpoints. Min endpoints go before max endpoints with the same value,
+// so touching objects count as overlapping (the same as rects_touch).
+static inline bool sap_less(sc2d_sap_endpoint e1, sc2d_sap_endpoint e2) {
+	return e1.value < e2.value || (e1.value == e2.value && !(e1.id & 1) && (e2.id & 1));
+}
+
+// Set endpoint values of one axis (0 = x, 1 = y) from the stored bounds
+static inline void sap_refresh_axis(sc2d_sap* sap, sc2d_sap_endpoint* axis, int axis_index) {
+	for (int i = 0; i < sap->count * 2; i++) {
+		int id = axis[i].id;
+		axis[i].value = sap->bounds[(id >> 1) * 4 + axis_index + (id & 1) * 2];
+	}
+}
+
+// Check if two objects overlap on one axis (0 = x, 1 = y) using the stored bounds
+static inline bool sap_overlap_axis(sc2d_sap* sap, int a, int b, int axis_index) {
+	float* b1 = sap->bounds + a * 4;
+	float* b2 = sap->bounds + b * 4;
+	return b1[axis_index] <= b2[axis_index + 2] && b2[axis_index] <= b1[axis_index + 2];
+}
+
+// Append a pair to a delta list, unless it cancels out a pair already in the opposite list
+static void sap_report(int a, int b, sc2d_pair* list, int capacity, int* count,
+					   sc2d_pair* opposite, int opposite_capacity, int* opposite_count) {
+	sc2d_pair pair;
+	pair.a = (a < b) ? a : b;
+	pair.b = (a < b) ? b : a;
+
+	for (int i = 0; *opposite_count <= opposite_capacity && i < *opposite_count; i++) {
+		if (opposite[i].a == pair.a && opposite[i].b == pair.b) {
+			opposite[i] = opposite[--(*opposite_count)];
+			return;
+		}
+	}
+
+	if (*count < capacity) list[*count] = pair;
+	(*count)++;
+}
+
+// Restore the order of one axis with an insertion sort, which is close to linear when objects move a little.
+// Each swap of a min and a max endpoint starts or ends an overlap on this axis.
+static void sap_sort_axis(sc2d_sap* sap, sc2d_sap_endpoint* axis, int axis_index,
+						  sc2d_pair* added, int added_capacity, int* added_count,
+						  sc2d_pair* removed, int removed_capacity, int* removed_count) {
+	int other_axis = 1 - axis_index;
+
+	for (int i = 1; i < sap->count * 2; i++) {
+		sc2d_sap_endpoint e = axis[i];
+		int j = i - 1;
+
+		while (j >= 0 && sap_less(e, axis[j])) {
+			int a = e.id >> 1, b = axis[j].id >> 1;
+			bool e_max = e.id & 1, passed_max = axis[j].id & 1;
+
+			if (!e_max && passed_max && sap_overlap_axis(sap, a, b, other_axis)) {
+				// e's min moved below the other object's max
+				sap_report(a, b, added, added_capacity, added_count, removed, removed_capacity, removed_count);
+			} else if (e_max && !passed_max && sap_overlap_axis(sap, a, b, other_axis)) {
+				// e's max moved below the other object's min
+				sap_report(a, b, removed, removed_capacity, removed_count, added, added_capacity, added_count);
+			}
+
+			axis[j + 1] = axis[j];
+			j--;
+		}
+
+		axis[j + 1] = e;
+	}
+}
+
+// Heap sort endpoints (only used to build the initial lists)
+static void sap_heap_sort(sc2d_sap_endpoint* axis, int n) {
+	for (int start = n / 2 - 1, end = n; end > 1; ) {
+		int root;
+		if (start >= 0) {
+			root = start--;
+		} else {
+			sc2d_sap_endpoint temp = axis[0];
+			axis[0] = axis[--end];
+			axis[end] = temp;
+			root = 0;
+		}
+
+		for (int child = root * 2 + 1; child < end; child = root * 2 + 1) {
+			if (child + 1 < end && sap_less(axis[child], axis[child + 1])) child++;
+			if (!sap_less(axis[root], axis[child])) break;
+
+			sc2d_sap_endpoint temp = axis[root];
+			axis[root] = axis[child];
+			axis[child] = temp;
+			root = child;
+		}
+	}
+}
+
+// Store the bounds of rectangles (left x[], top y[], width w[], height h[]) for one axis (0 = x, 1 = y)
+// Negative and NaN sizes are stored as 0, so every min endpoint sorts before its max endpoint.
+static inline void sap_store_bounds(sc2d_sap* sap, float* position, float* size, int axis_index) {
+	for (int i = 0; i < sap->count; i++) {
+		sap->bounds[i * 4 + axis_index] = position[i];
+		sap->bounds[i * 4 + axis_index + 2] = position[i] + ((size[i] > 0) ? size[i] : 0);
+	}
+}
+
+// Set up sweep and prune for count rectangles (left x[], top y[], width w[], height h[]) using caller-owned memory
+// endpoints: 4 * count endpoints, bounds: 4 * count floats
+// No pairs are reported for the initial positions, use sc2d_sap_pairs to get them.
+void sc2d_sap_init(sc2d_sap* sap, sc2d_sap_endpoint* endpoints, float* bounds, float* x, float* y, float* w, float* h, int count) {
+	sap->axis_x = endpoints;
+	sap->axis_y = endpoints + count * 2;
+	sap->bounds = bounds;
+	sap->count = count;
+
+	sap_store_bounds(sap, x, w, 0);
+	sap_store_bounds(sap, y, h, 1);
+
+	for (int i = 0; i < count * 2; i++) {
+		sap->axis_x[i].id = i;
+		sap->axis_y[i].id = i;
+	}
+
+	sap_refresh_axis(sap, sap->axis_x, 0);
+	sap_refresh_axis(sap, sap->axis_y, 1);
+	sap_heap_sort(sap->axis_x, count * 2);
+	sap_heap_sort(sap->axis_y, count * 2);
+}
+
+// Find every pair of overlapping objects by sweeping the sorted x axis
+// Returns the number of pairs found, which may be more than pair_capacity (only pair_capacity pairs are written).
+int sc2d_sap_pairs(sc2d_sap* sap, sc2d_pair* pairs, int pair_capacity) {
+	int pair_count = 0;
+
+	for (int i = 0; i < sap->count * 2; i++) {
+		if (sap->axis_x[i].id & 1) continue;
+		int a = sap->axis_x[i].id >> 1;
+
+		// Every object that starts before a ends overlaps it on x
+		// (bounded by the endpoint count as well, in case a NaN position left a's max out of order)
+		for (int j = i + 1; j < sap->count * 2 && sap->axis_x[j].id != (a * 2 + 1); j++) {
+			if (sap->axis_x[j].id & 1) continue;
+			int b = sap->axis_x[j].id >> 1;
+
+			if (sap_overlap_axis(sap, a, b, 1)) {
+				if (pair_count < pair_capacity) {
+					pairs[pair_count].a = (a < b) ? a : b;
+					pairs[pair_count].b = (a < b) ? b : a;
+				}
+				pair_count++;
+			}
+		}
+	}
+
+	return pair_count;
+}
+
+// Move every object to new bounds (left x[], top y[], width w[], height h[]) and report overlap changes
+// added: pairs that started overlapping, removed: pairs that stopped overlapping (each pair with a < b).
+// If a count is larger than its capacity the lists are incomplete, and sc2d_sap_pairs should be used to resync.
+void sc2d_sap_update(sc2d_sap* sap, float* x, float* y, float* w, float* h,
+					 sc2d_pair* added, int added_capacity, int* added_count,
+					 sc2d_pair* removed, int removed_capacity, int* removed_count) {
+	*added_count = 0;
+	*removed_count = 0;
+
+	// Update one axis at a time, so every swap is tested against the current bounds of the other axis
+	sap_store_bounds(sap, x, w, 0);
+	sap_refresh_axis(sap, sap->axis_x, 0);
+	sap_sort_axis(sap, sap->axis_x, 0, added, added_capacity, added_count, removed, removed_capacity, removed_count);
+
+	sap_store_bounds(sap, y, h, 1);
+	sap_refresh_axis(sap, sap->axis_y, 1);
+	sap_sort_axis(sap, sap->axis_y, 1, added, added_capacity, added_count, removed, removed_capacity, removed_count);
+}
+
+// Maximum traversal stack depth of sc2d_bvh queries. Balanced trees are far shallower than this,
+// and a query that would need more returns -1 instead of skipping subtrees.
+#ifndef SC2D_BVH_STACK_SIZE
+#define SC2D_BVH_STACK_SIZE 256
+#endif
+
+static inline bool bvh_is_leaf(sc2d_bvh_node* node) {
+	return node->left == -1;
+}
+
+// Perimeter of the union of two nodes' bounds (cost metric for insertion)
+static inline float bvh_union_perimeter(sc2d_bvh_node* n1, sc2d_bvh_node* n2) {
+	float w = sc2d_max(n1->max_x, n2->max_x) - sc2d_min(n1->min_x, n2->min_x);
+	float h = sc2d_max(n1->max_y, n2->max_y) - sc2d_min(n1->min_y, n2->min_y);
+	return 2.0f * (w + h);
+}
+
+static inline float bvh_perimeter(sc2d_bvh_node* node) {
+	return 2.0f * ((node->max_x - node->min_x) + (node->max_y - node->min_y));
+}
+
+static inline bool bvh_overlap(sc2d_bvh_node* n1, sc2d_bvh_node* n2) {
+	return n1->min_x <= n2->max_x && n2->min_x <= n1->max_x && n1->min_y <= n2->max_y && n2->min_y <= n1->max_y;
+}
+
+// Set the bounds and height of an internal node from its children
+static inline void bvh_refit(sc2d_bvh* bvh, int index) {
+	sc2d_bvh_node* node = bvh->nodes + index;
+	sc2d_bvh_node* left = bvh->nodes + node->left;
+	sc2d_bvh_node* right = bvh->nodes + node->right;
+
+	node->min_x = sc2d_min(left->min_x, right->min_x);
+	node->min_y = sc2d_min(left->min_y, right->min_y);
+	node->max_x = sc2d_max(left->max_x, right->max_x);
+	node->max_y = sc2d_max(left->max_y, right->max_y);
+	node->height = 1 + ((left->height > right->height) ? left->height : right->height);
+}
+
+static int bvh_allocate(sc2d_bvh* bvh) {
+	int index = bvh->free_list;
+	if (index != -1) {
+		sc2d_bvh_node* node = bvh->nodes + index;
+		bvh->free_list = node->parent;
+		node->parent = node->left = node->right = -1;
+		node->height = 0;
+		node->id = -1;
+	}
+	return index;
+}
+
+static void bvh_free(sc2d_bvh* bvh, int index) {
+	bvh->nodes[index].parent = bvh->free_list;
+	bvh->nodes[index].height = -1;
+	bvh->free_list = index;
+}
+
+// Replace child with new_child in the parent of child (or the root)
+static inline void bvh_replace_child(sc2d_bvh* bvh, int parent, int child, int new_child) {
+	if (parent == -1) {
+		bvh->root = new_child;
+	} else if (bvh->nodes[parent].left == child) {
+		bvh->nodes[parent].left = new_child;
+	} else {
+		bvh->nodes[parent].right = new_child;
+	}
+}
+
+// Rotate the taller child of node a up if the subtree is unbalanced. Returns the new root of the subtree.
+static int bvh_balance(sc2d_bvh* bvh, int a) {
+	sc2d_bvh_node* nodes = bvh->nodes;
+	if (bvh_is_leaf(nodes + a) || nodes[a].height < 2) return a;
+
+	int b = nodes[a].left;
+	int c = nodes[a].right;
+	int balance = nodes[c].height - nodes[b].height;
+
+	if (balance > 1 || balance < -1) {
+		// up is the taller child. It takes a's place, and a keeps the shorter grandchild.
+		int up = (balance > 1) ? c : b;
+		int up_left = nodes[up].left, up_right = nodes[up].right;
+		int tall = (nodes[up_left].height > nodes[up_right].height) ? up_left : up_right;
+		int short_child = (tall == up_left) ? up_right : up_left;
+
+		nodes[up].parent = nodes[a].parent;
+		bvh_replace_child(bvh, nodes[a].parent, a, up);
+		nodes[a].parent = up;
+
+		nodes[up].left = a;
+		nodes[up].right = tall;
+		if (up == c) nodes[a].right = short_child;
+		else nodes[a].left = short_child;
+		nodes[short_child].parent = a;
+
+		bvh_refit(bvh, a);
+		bvh_refit(bvh, up);
+		return up;
+	}
+
+	return a;
+}
+
+// Refit and rebalance every node from index up to the root
+static void bvh_fix_upwards(sc2d_bvh* bvh, int index) {
+	while (index != -1) {
+		index = bvh_balance(bvh, index);
+		bvh_refit(bvh, index);
+		index = bvh->nodes[index].parent;
+	}
+}
+
+static void bvh_insert_leaf(sc2d_bvh* bvh, int leaf, int parent) {
+	sc2d_bvh_node* nodes = bvh->nodes;
+
+	if (bvh->root == -1) {
+		bvh->root = leaf;
+		nodes[leaf].parent = -1;
+		return;
+	}
+
+	// Descend to the sibling that increases the total perimeter of the tree the least
+	int index = bvh->root;
+	while (!bvh_is_leaf(nodes + index)) {
+		int left = nodes[index].left, right = nodes[index].right;
+		float combined = bvh_union_perimeter(nodes + index, nodes + leaf);
+		float cost = 2.0f * combined; // Cost of a new parent for this node and the leaf
+		float inheritance = 2.0f * (combined - bvh_perimeter(nodes + index)); // Minimum cost of pushing the leaf further down
+
+		float cost_left = bvh_union_perimeter(nodes + left, nodes + leaf) + inheritance;
+		float cost_right = bvh_union_perimeter(nodes + right, nodes + leaf) + inheritance;
+		if (!bvh_is_leaf(nodes + left)) cost_left -= bvh_perimeter(nodes + left);
+		if (!bvh_is_leaf(nodes + right)) cost_right -= bvh_perimeter(nodes + right);
+
+		if (cost < cost_left && cost < cost_right) break;
+		index = (cost_left < cost_right) ? left : right;
+	}
+
+	// Create a new parent for the sibling and the leaf
+	int sibling = index;
+	int old_parent = nodes[sibling].parent;
+
+	nodes[parent].parent = old_parent;
+	nodes[parent].left = sibling;
+	nodes[parent].right = leaf;
+	bvh_replace_child(bvh, old_parent, sibling, parent);
+	nodes[sibling].parent = parent;
+	nodes[leaf].parent = parent;
+
+	bvh_fix_upwards(bvh, parent);
+}
+
+// Detach a leaf from the tree. Returns its old parent node, which is no longer used by the tree.
+static int bvh_remove_leaf(sc2d_bvh* bvh, int leaf) {
+	sc2d_bvh_node* nodes = bvh->nodes;
+
+	if (leaf == bvh->root) {
+		bvh->root = -1;
+		return -1;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grandparent = nodes[parent].parent;
+	int sibling = (nodes[parent].left == leaf) ? nodes[parent].right : nodes[parent].left;
+
+	bvh_replace_child(bvh, grandparent, parent, sibling);
+	nodes[sibling].parent = grandparent;
+	nodes[leaf].parent = -1;
+
+	bvh_fix_upwards(bvh, grandparent);
+	return parent;
+}
+
+// Set the fat bounds of a leaf from a rectangle (left x, top y, width, height)
+static inline void bvh_set_leaf_bounds(sc2d_bvh* bvh, int leaf, float x, float y, float w, float h) {
+	sc2d_bvh_node* node = bvh->nodes + leaf;
+	node->min_x = x - bvh->margin;
+	node->min_y = y - bvh->margin;
+	node->max_x = x + w + bvh->margin;
+	node->max_y = y + h + bvh->margin;
+}
+
+// Set up a tree using caller-owned memory. A tree with n objects needs 2n - 1 nodes.
+// margin: distance that leaf bounds are enlarged by on each side
+void sc2d_bvh_init(sc2d_bvh* bvh, sc2d_bvh_node* nodes, int capacity, float margin) {
+	bvh->nodes = nodes;
+	bvh->capacity = capacity;
+	bvh->root = -1;
+	bvh->margin = margin;
+	bvh->free_list = -1;
+
+	for (int i = capacity - 1; i >= 0; i--) bvh_free(bvh, i);
+}
+
+// Insert a rectangle (left x, top y, width, height) with a user id
+// Returns the proxy (node index) used to move or remove it, or -1 if the tree is full.
+int sc2d_bvh_insert(sc2d_bvh* bvh, int id, float x, float y, float w, float h) {
+	int leaf = bvh_allocate(bvh);
+	if (leaf == -1) return -1;
+
+	int parent = -1;
+	if (bvh->root != -1 && (parent = bvh_allocate(bvh)) == -1) {
+		bvh_free(bvh, leaf);
+		return -1;
+	}
+
+	bvh->nodes[leaf].id = id;
+	bvh_set_leaf_bounds(bvh, leaf, x, y, w, h);
+	bvh_insert_leaf(bvh, leaf, parent);
+
+	return leaf;
+}
+
+// Remove a proxy returned by sc2d_bvh_insert
+void sc2d_bvh_remove(sc2d_bvh* bvh, int proxy) {
+	int parent = bvh_remove_leaf(bvh, proxy);
+	if (parent != -1) bvh_free(bvh, parent);
+	bvh_free(bvh, proxy);
+}
+
+// Update the bounds (left x, top y, width, height) of a proxy
+// Returns true if the object left its fat bounds and was reinserted, false if the tree did not change.
+bool sc2d_bvh_move(sc2d_bvh* bvh, int proxy, float x, float y, float w, float h) {
+	sc2d_bvh_node* node = bvh->nodes + proxy;
+	if (x >= node->min_x && y >= node->min_y && x + w <= node->max_x && y + h <= node->max_y) {
+		return false;
+	}
+
+	int parent = bvh_remove_leaf(bvh, proxy);
+	bvh_set_leaf_bounds(bvh, proxy, x, y, w, h);
+	bvh_insert_leaf(bvh, proxy, parent);
+
+	return true;
+}
+
+// Find the ids of every leaf whose fat bounds overlap a node-shaped query (used by the rect and point queries)
+static int bvh_query_bounds(sc2d_bvh* bvh, sc2d_bvh_node* query, int* results, int result_capacity) {
+	int result_count = 0;
+	int stack[SC2D_BVH_STACK_SIZE];
+	int top = 0;
+
+	if (bvh->root != -1) stack[top++] = bvh->root;
+	while (top > 0) {
+		sc2d_bvh_node* node = bvh->nodes + stack[--top];
+		if (!bvh_overlap(node, query)) continue;
+
+		if (bvh_is_leaf(node)) {
+			if (result_count < result_capacity) results[result_count] = node->id;
+			result_count++;
+		} else {
+			if (top + 2 > SC2D_BVH_STACK_SIZE) return -1;
+			stack[top++] = node->left;
+			stack[top++] = node->right;
+		}
+	}
+
+	return result_count;
+}
+
+// Find the ids of every object whose fat bounds overlap a rectangle (left x, top y, width, height)
+// Returns the number of results found, which may be more than result_capacity (only result_capacity are written),
+// or -1 if the tree is too deep for SC2D_BVH_STACK_SIZE.
+int sc2d_bvh_query_rect(sc2d_bvh* bvh, float x, float y, float w, float h, int* results, int result_capacity) {
+	sc2d_bvh_node query;
+	query.min_x = x;
+	query.min_y = y;
+	query.max_x = x + w;
+	query.max_y = y + h;
+
+	return bvh_query_bounds(bvh, &query, results, result_capacity);
+}
+
+// Find the ids of every object whose fat bounds contain a point
+// Returns the number of results found, which may be more than result_capacity (only result_capacity are written),
+// or -1 if the tree is too deep for SC2D_BVH_STACK_SIZE.
+int sc2d_bvh_query_point(sc2d_bvh* bvh, float px, float py, int* results, int result_capacity) {
+	sc2d_bvh_node query;
+	query.min_x = query.max_x = px;
+	query.min_y = query.max_y = py;
+
+	return bvh_query_bounds(bvh, &query, results, result_capacity);
+}
+
+// Check if the segment from start to end (delta_x, delta_y) touches a node's bounds (slab test)
+static inline bool bvh_segment_touches(sc2d_bvh_node* node, float start_x, float start_y, float delta_x, float delta_y) {
+	float t_min = 0.0f, t_max = 1.0f;
+	float start[2] = {start_x, start_y};
+	float delta[2] = {delta_x, delta_y};
+	float min[2] = {node->min_x, node->min_y};
+	float max[2] = {node->max_x, node->max_y};
+
+	for (int axis = 0; axis < 2; axis++) {
+		if (delta[axis] == 0.0f) {
+			if (start[axis] < min[axis] || start[axis] > max[axis]) return false;
+		} else {
+			float t1 = (min[axis] - start[axis]) / delta[axis];
+			float t2 = (max[axis] - start[axis]) / delta[axis];
+			t_min = sc2d_max(t_min, sc2d_min(t1, t2));
+			t_max = sc2d_min(t_max, sc2d_max(t1, t2));
+			if (t_min > t_max) return false;
+		}
+	}
+
+	return true;
+}
+
+// Find the ids of every object whose fat bounds are touched by the segment from start to end
+// Returns the number of results found, which may be more than result_capacity (only result_capacity are written),
+// or -1 if the tree is too deep for SC2D_BVH_STACK_SIZE.
+int sc2d_bvh_query_ray(sc2d_bvh* bvh, float start_x, float start_y, float end_x, float end_y, int* results, int result_capacity) {
+	int result_count = 0;
+	int stack[SC2D_BVH_STACK_SIZE];
+	int top = 0;
+	float delta_x = end_x - start_x;
+	float delta_y = end_y - start_y;
+
+	if (bvh->root != -1) stack[top++] = bvh->root;
+	while (top > 0) {
+		sc2d_bvh_node* node = bvh->nodes + stack[--top];
+		if (!bvh_segment_touches(node, start_x, start_y, delta_x, delta_y)) continue;
+
+		if (bvh_is_leaf(node)) {
+			if (result_count < result_capacity) results[result_count] = node->id;
+			result_count++;
+		} else {
+			if (top + 2 > SC2D_BVH_STACK_SIZE) return -1;
+			stack[top++] = node->left;
+			stack[top++] = node->right;
+		}
+	}
+
+	return result_count;
+}
+
+// Find every pair of objects (a from bvh1, b from bvh2) whose fat bounds overlap
+// If bvh1 and bvh2 are the same tree, every overlapping pair within it is reported once.
+// Returns the number of pairs found, which may be more than pair_capacity (only pair_capacity pairs are written),
+// or -1 if the trees are too deep for SC2D_BVH_STACK_SIZE.
+int sc2d_bvh_query_pairs(sc2d_bvh* bvh1, sc2d_bvh* bvh2, sc2d_pair* pairs, int pair_capacity) {
+	int pair_count = 0;
+	int stack[SC2D_BVH_STACK_SIZE * 2];
+	int top = 0;
+	bool same_tree = (bvh1 == bvh2);
+
+	if (bvh1->root == -1 || bvh2->root == -1) return 0;
+	stack[top++] = bvh1->root;
+	stack[top++] = bvh2->root;
+
+	while (top > 0) {
+		int i2 = stack[--top];
+		int i1 = stack[--top];
+		sc2d_bvh_node* n1 = bvh1->nodes + i1;
+		sc2d_bvh_node* n2 = bvh2->nodes + i2;
+
+		if (same_tree && i1 == i2) {
+			// Pairs within one subtree: both children against themselves and each other
+			if (!bvh_is_leaf(n1)) {
+				if (top + 6 > SC2D_BVH_STACK_SIZE * 2) return -1;
+				stack[top++] = n1->left;  stack[top++] = n1->left;
+				stack[top++] = n1->right; stack[top++] = n1->right;
+				stack[top++] = n1->left;  stack[top++] = n1->right;
+			}
+			continue;
+		}
+
+		if (!bvh_overlap(n1, n2)) continue;
+
+		if (bvh_is_leaf(n1) && bvh_is_leaf(n2)) {
+			if (pair_count < pair_capacity) {
+				pairs[pair_count].a = n1->id;
+				pairs[pair_count].b = n2->id;
+			}
+			pair_count++;
+		} else {
+			// Descend into the larger node
+			if (top + 4 > SC2D_BVH_STACK_SIZE * 2) return -1;
+			if (bvh_is_leaf(n2) || (!bvh_is_leaf(n1) && bvh_perimeter(n1) > bvh_perimeter(n2))) {
+				stack[top++] = n1->left;  stack[top++] = i2;
+				stack[top++] = n1->right; stack[top++] = i2;
+			} else {
+				stack[top++] = i1; stack[top++] = n2->left;
+				stack[top++] = i1; stack[top++] = n2->right;
+			}
+		}
+	}
+
+	return pair_count;
+}
+
+#define SC2D_WORLD_FREE 0xff		// Type of free slots
+#define SC2D_WORLD_ALIGN 64			// Alignment of the world's arrays, a cache line
+#define SC2D_WORLD_GENERATION_MASK ((1u << (32 - SC2D_WORLD_INDEX_BITS)) - 1)
+
+// Shape flags. The first three are cleared by each step.
+#define SC2D_WORLD_DIRTY 1			// Added or moved, and in the dirty list
+#define SC2D_WORLD_ADDED 2
+#define SC2D_WORLD_REINSERTED 4		// BVH leaf bounds changed
+#define SC2D_WORLD_SLEEPING 8
+#define SC2D_WORLD_RESTLESS 16		// Island root with a shape that can't sleep, while islands are built
+
+// Shapes whose moves stay below SC2D_WORLD_SLEEP_MOTION and whose overlaps stay below SC2D_WORLD_SLEEP_OVERLAP
+// (in world units) for SC2D_WORLD_SLEEP_STEPS steps fall asleep with everything they touch. 0 steps disables sleeping.
+#ifndef SC2D_WORLD_SLEEP_STEPS
+#define SC2D_WORLD_SLEEP_STEPS 30
+#endif
+
+#ifndef SC2D_WORLD_SLEEP_MOTION
+#define SC2D_WORLD_SLEEP_MOTION 0.05f
+#endif
+
+#ifndef SC2D_WORLD_SLEEP_OVERLAP
+#define SC2D_WORLD_SLEEP_OVERLAP 0.1f
+#endif
+
+// A step rebuilds its pairs with one BVH pair query, instead of a query per shape, when more than
+// 1 / SC2D_WORLD_REBUILD_SHARE of the shapes left their leaf bounds
+#ifndef SC2D_WORLD_REBUILD_SHARE
+#define SC2D_WORLD_REBUILD_SHARE 8
+#endif
+
+// Floats per vertex in the layout sc2d_collide reads
+static inline int world_vert_stride(void) {
+#ifndef SIMPLE_COLLISION_2D_VECTOR2
+	typedef struct sc2d_v2 {float x, y;} sc2d_v2;
+#endif
+	return (int)(sizeof(sc2d_v2) / sizeof(float));
+}
+
+// Take the next array of size bytes from memory, or only count it if memory is NULL
+static void* world_carve(char* memory, size_t* used, size_t size) {
+	void* array = memory ? memory + *used : NULL;
+	*used += (size + SC2D_WORLD_ALIGN - 1) & ~(size_t)(SC2D_WORLD_ALIGN - 1);
+	return array;
+}
+
+// Point the world's arrays into memory (aligned to SC2D_WORLD_ALIGN). Returns the number of bytes they use.
+static size_t world_layout(sc2d_world* world, char* memory, int capacity, int vert_capacity, int pair_capacity) {
+	size_t used = 0;
+	size_t n = (size_t)capacity;
+
+	world->type = (unsigned char*)world_carve(memory, &used, n);
+	world->flags = (unsigned char*)world_carve(memory, &used, n);
+	world->x = (float*)world_carve(memory, &used, n * sizeof(float));
+	world->y = (float*)world_carve(memory, &used, n * sizeof(float));
+	world->w = (float*)world_carve(memory, &used, n * sizeof(float));
+	world->h = (float*)world_carve(memory, &used, n * sizeof(float));
+	world->r = (float*)world_carve(memory, &used, n * sizeof(float));
+	world->bounds = (float*)world_carve(memory, &used, 4 * n * sizeof(float));
+
+	world->local_bounds = (float*)world_carve(memory, &used, 4 * n * sizeof(float));
+	world->leaf_bounds = (float*)world_carve(memory, &used, 4 * n * sizeof(float));
+	world->generation = (unsigned int*)world_carve(memory, &used, n * sizeof(unsigned int));
+	world->proxy = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->vert_offset = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->vert_count = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->moved_step = (unsigned int*)world_carve(memory, &used, n * sizeof(unsigned int));
+	world->island = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->island_next = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->awake_index = (int*)world_carve(memory, &used, n * sizeof(int));
+
+	world->verts = (float*)world_carve(memory, &used, (size_t)vert_capacity * world_vert_stride() * sizeof(float));
+	world->vert_owner = (int*)world_carve(memory, &used, (size_t)vert_capacity * sizeof(int));
+
+	world->dirty = (int*)world_carve(memory, &used, n * sizeof(int));
+	world->awake = (int*)world_carve(memory, &used, n * sizeof(int));
+
+	world->bvh.nodes = (sc2d_bvh_node*)world_carve(memory, &used, 2 * n * sizeof(sc2d_bvh_node));
+	world->pairs = (sc2d_world_pair*)world_carve(memory, &used, (size_t)pair_capacity * sizeof(sc2d_world_pair));
+	world->candidates = (sc2d_pair*)world_carve(memory, &used, (size_t)pair_capacity * sizeof(sc2d_pair));
+	world->hits = (sc2d_world_hit*)world_carve(memory, &used, (size_t)pair_capacity * sizeof(sc2d_world_hit));
+
+	return used;
+}
+
+// Slot of a handle, or -1 if the handle is stale or invalid
+static inline int world_slot(sc2d_world* world, sc2d_handle handle) {
+	int slot = (int)(handle & ((1u << SC2D_WORLD_INDEX_BITS) - 1));
+	if (slot >= world->slot_count || world->type[slot] == SC2D_WORLD_FREE) return -1;
+	if (world->generation[slot] != handle >> SC2D_WORLD_INDEX_BITS) return -1;
+	return slot;
+}
+
+static inline sc2d_handle world_handle(sc2d_world* world, int slot) {
+	return (sc2d_handle)slot | (world->generation[slot] << SC2D_WORLD_INDEX_BITS);
+}
+
+// Bounds of a slot relative to its position. Polygon bounds include the position, which SAT treats as part of the polygon.
+static void world_local_bounds(sc2d_world* world, int slot, float* bounds) {
+	float w = world->w[slot], h = world->h[slot], r = world->r[slot];
+
+	switch (world->type[slot]) {
+		case SC2D_SHAPE_CIRCLE:
+			bounds[0] = -r; bounds[1] = -r; bounds[2] = r; bounds[3] = r;
+			break;
+
+		case SC2D_SHAPE_RECT:
+			bounds[0] = 0; bounds[1] = 0; bounds[2] = w; bounds[3] = h;
+			break;
+
+		case SC2D_SHAPE_CAPSULE:
+			w = sc2d_fabsf(w) + r;
+			h = sc2d_fabsf(h) + r;
+			bounds[0] = -w; bounds[1] = -h; bounds[2] = w; bounds[3] = h;
+			break;
+
+		default: {
+			sc2d_verts verts = v2_view(world->verts + (size_t)world->vert_offset[slot] * world->vert_stride, world->vert_count[slot]);
+			bounds[0] = 0; bounds[1] = 0; bounds[2] = 0; bounds[3] = 0;
+
+			for (int i = 0; i < verts.count; i++) {
+				bounds[0] = sc2d_min(bounds[0], vert_x(&verts, i));
+				bounds[1] = sc2d_min(bounds[1], vert_y(&verts, i));
+				bounds[2] = sc2d_max(bounds[2], vert_x(&verts, i));
+				bounds[3] = sc2d_max(bounds[3], vert_y(&verts, i));
+			}
+			break;
+		}
+	}
+}
+
+// Set a slot's bounds from its position
+static inline void world_update_bounds(sc2d_world* world, int slot) {
+	float* bounds = world->bounds + 4 * slot;
+	float* local = world->local_bounds + 4 * slot;
+
+	bounds[0] = world->x[slot] + local[0];
+	bounds[1] = world->y[slot] + local[1];
+	bounds[2] = world->x[slot] + local[2];
+	bounds[3] = world->y[slot] + local[3];
+}
+
+// Move the arena's polygons down over the holes left by removed ones
+static void world_compact_verts(sc2d_world* world) {
+	int stride = world->vert_stride;
+	int write = 0;
+
+	for (int read = 0; read < world->vert_used;) {
+		int owner = world->vert_owner[read];
+		if (owner < 0) {
+			read += -1 - owner;
+			continue;
+		}
+
+		int count = world->vert_count[owner];
+		if (write != read) {
+			float* src = world->verts + (size_t)read * stride;
+			float* dst = world->verts + (size_t)write * stride;
+			for (int i = 0; i < count * stride; i++) dst[i] = src[i];
+
+			world->vert_owner[write] = owner;
+			world->vert_offset[owner] = write;
+		}
+		write += count;
+		read += count;
+	}
+
+	world->vert_used = write;
+	world->vert_free = 0;
+}
+
+// Fill an sc2d_shape from a slot
+static inline void world_shape(sc2d_world* world, int slot, sc2d_shape* shape) {
+	shape->type = world->type[slot];
+	shape->x = world->x[slot];
+	shape->y = world->y[slot];
+	shape->w = world->w[slot];
+	shape->h = world->h[slot];
+	shape->r = world->r[slot];
+	shape->verts = world->vert_count[slot] ? world->verts + (size_t)world->vert_offset[slot] * world->vert_stride : NULL;
+	shape->count = world->vert_count[slot];
+	shape->packed = false;
+}
+
+// Put a shape in the dirty list, so the next step retests its pairs
+static inline void world_mark_dirty(sc2d_world* world, int slot, unsigned char flags) {
+	if (!(world->flags[slot] & SC2D_WORLD_DIRTY)) world->dirty[world->dirty_count++] = slot;
+	world->flags[slot] |= SC2D_WORLD_DIRTY | flags;
+}
+
+static inline void world_add_awake(sc2d_world* world, int slot) {
+	world->awake_index[slot] = world->awake_count;
+	world->awake[world->awake_count++] = slot;
+}
+
+static inline void world_remove_awake(sc2d_world* world, int slot) {
+	int index = world->awake_index[slot];
+	int last = world->awake[--world->awake_count];
+
+	world->awake[index] = last;
+	world->awake_index[last] = index;
+}
+
+// Wake a sleeping shape and the rest of its island
+static void world_wake_island(sc2d_world* world, int slot) {
+	if (!(world->flags[slot] & SC2D_WORLD_SLEEPING)) return;
+
+	int shape = slot;
+	world->woke = true;
+	do {
+		world->flags[shape] &= ~SC2D_WORLD_SLEEPING;
+		world->moved_step[shape] = world->step;
+		world_add_awake(world, shape);
+		shape = world->island_next[shape];
+	} while (shape != slot);
+}
+
+static inline int world_find_island(int* island, int slot) {
+	while (island[slot] != slot) {
+		island[slot] = island[island[slot]];
+		slot = island[slot];
+	}
+	return slot;
+}
+
+// Check if the BVH leaf bounds of two shapes overlapped at the last step, like bvh_overlap
+static inline bool world_leaves_overlapped(sc2d_world* world, int a, int b) {
+	float* bounds_a = world->leaf_bounds + 4 * a;
+	float* bounds_b = world->leaf_bounds + 4 * b;
+	return bounds_a[0] <= bounds_b[2] && bounds_b[0] <= bounds_a[2] && bounds_a[1] <= bounds_b[3] && bounds_b[1] <= bounds_a[3];
+}
+
+// Test a pair with an exact bounds check and sc2d_collide
+// With wake set, sleeping shapes wake up with their island when the pair starts or stops touching.
+static void world_test_pair(sc2d_world* world, sc2d_world_pair* pair, bool wake) {
+	int a = pair->a, b = pair->b;
+	bool was_hit = pair->hit;
+	float* bounds_a = world->bounds + 4 * a;
+	float* bounds_b = world->bounds + 4 * b;
+
+	pair->hit = false;
+	if (bounds_a[0] <= bounds_b[2] && bounds_b[0] <= bounds_a[2] && bounds_a[1] <= bounds_b[3] && bounds_b[1] <= bounds_a[3]) {
+		sc2d_shape s1, s2;
+		world_shape(world, a, &s1);
+		world_shape(world, b, &s2);
+
+		world->test_count++;
+		pair->hit = sc2d_collide(&s1, &s2, &pair->overlap_x, &pair->overlap_y);
+	}
+
+	if (wake && (pair->hit || was_hit)) {
+		world_wake_island(world, a);
+		world_wake_island(world, b);
+	}
+}
+
+// Append a new pair of slots and test it. Returns false if the pair list is full.
+static inline bool world_add_pair(sc2d_world* world, int a, int b) {
+	if (world->pair_count == world->pair_capacity) {
+		world->dropped++;
+		return false;
+	}
+
+	sc2d_world_pair* pair = world->pairs + world->pair_count++;
+	pair->a = (a < b) ? a : b;
+	pair->b = (a < b) ? b : a;
+	pair->hit = false;
+	world_test_pair(world, pair, ((world->flags[a] | world->flags[b]) & SC2D_WORLD_DIRTY) != 0);
+	return true;
+}
+
+// Group the awake shapes into islands of touching shapes, and put the islands whose shapes all rested
+// for SC2D_WORLD_SLEEP_STEPS to sleep. Costs a pass over the awake shapes and the pairs that aren't set aside.
+// Returns true if any shape fell asleep.
+static bool world_sleep_islands(sc2d_world* world) {
+	bool fell_asleep = false;
+	int* island = world->island;
+	float max_overlap = SC2D_WORLD_SLEEP_OVERLAP * SC2D_WORLD_SLEEP_OVERLAP;
+
+	for (int i = 0; i < world->awake_count; i++) {
+		int slot = world->awake[i];
+		island[slot] = slot;
+		world->island_next[slot] = slot;
+		world->flags[slot] &= ~SC2D_WORLD_RESTLESS;
+	}
+
+	for (int i = world->sleeping_pair_count; i < world->pair_count; i++) {
+		sc2d_world_pair* pair = world->pairs + i;
+		if (!pair->hit || ((world->flags[pair->a] | world->flags[pair->b]) & SC2D_WORLD_SLEEPING)) continue;
+
+		// Shapes that overlap this much are about to be pushed apart, so they are not at rest
+		if (pair->overlap_x * pair->overlap_x + pair->overlap_y * pair->overlap_y > max_overlap) {
+			world->moved_step[pair->a] = world->step;
+			world->moved_step[pair->b] = world->step;
+		}
+
+		int a = world_find_island(island, pair->a);
+		int b = world_find_island(island, pair->b);
+		if (a != b) island[a] = b;
+	}
+
+	for (int i = 0; i < world->awake_count; i++) {
+		int slot = world->awake[i];
+		int root = world_find_island(island, slot);
+		island[slot] = root;
+
+		if (world->step - world->moved_step[slot] < SC2D_WORLD_SLEEP_STEPS) world->flags[root] |= SC2D_WORLD_RESTLESS;
+	}
+
+	// Backwards, so removing from the awake list only moves shapes that were already visited
+	for (int i = world->awake_count - 1; i >= 0; i--) {
+		int slot = world->awake[i];
+		int root = island[slot];
+		if (world->flags[root] & SC2D_WORLD_RESTLESS) continue;
+
+		if (slot != root) {
+			world->island_next[slot] = world->island_next[root];
+			world->island_next[root] = slot;
+		}
+		world->flags[slot] |= SC2D_WORLD_SLEEPING;
+		world_remove_awake(world, slot);
+		fell_asleep = true;
+	}
+
+	return fell_asleep;
+}
+
+static inline void world_store_hit(sc2d_world* world, sc2d_world_hit* hit, sc2d_world_pair* pair) {
+	hit->a = world_handle(world, pair->a);
+	hit->b = world_handle(world, pair->b);
+	hit->overlap_x = pair->overlap_x;
+	hit->overlap_y = pair->overlap_y;
+}
+
+// Bytes of memory sc2d_world_init needs for the given capacities
+// vert_capacity is the total number of polygon vertices, pair_capacity the number of shape pairs whose BVH leaf
+// bounds overlap (the leaf bounds are enlarged by the margin).
+size_t sc2d_world_memory_size(int shape_capacity, int vert_capacity, int pair_capacity) {
+	sc2d_world world;
+	return world_layout(&world, NULL, shape_capacity, vert_capacity, pair_capacity) + SC2D_WORLD_ALIGN - 1;
+}
+
+// Set up an empty world in caller-owned memory of at least sc2d_world_memory_size bytes
+// margin: distance that BVH leaf bounds are enlarged by, see sc2d_bvh_init. Returns false if memory is too small.
+bool sc2d_world_init(sc2d_world* world, void* memory, size_t memory_size, int shape_capacity, int vert_capacity,
+					 int pair_capacity, float margin) {
+	if (shape_capacity <= 0 || shape_capacity > (1 << SC2D_WORLD_INDEX_BITS) || vert_capacity < 0 || pair_capacity < 0) {
+		return false;
+	}
+	if (memory_size < sc2d_world_memory_size(shape_capacity, vert_capacity, pair_capacity)) return false;
+
+	char* aligned = (char*)memory + (SC2D_WORLD_ALIGN - (size_t)memory % SC2D_WORLD_ALIGN) % SC2D_WORLD_ALIGN;
+	world_layout(world, aligned, shape_capacity, vert_capacity, pair_capacity);
+
+	world->capacity = shape_capacity;
+	world->slot_count = 0;
+	world->shape_count = 0;
+	world->free_slot = -1;
+	world->vert_stride = world_vert_stride();
+	world->vert_capacity = vert_capacity;
+	world->vert_used = 0;
+	world->vert_free = 0;
+	world->dirty_count = 0;
+	world->awake_count = 0;
+	world->pair_count = 0;
+	world->sleeping_pair_count = 0;
+	world->hit_count = 0;
+	world->sleeping_hit_count = 0;
+	world->woke = false;
+	world->pair_capacity = pair_capacity;
+	world->test_count = 0;
+	world->dropped = 0;
+	world->step = 0;
+
+	for (int i = 0; i < shape_capacity; i++) world->generation[i] = 1;
+	sc2d_bvh_init(&world->bvh, world->bvh.nodes, 2 * shape_capacity, margin);
+	return true;
+}
+
+// Add a copy of a shape to the world. Polygon vertices are copied into the world's arena.
+// Returns the shape's handle, or 0 if the world has no free slot or not enough vertex space.
+sc2d_handle sc2d_world_add(sc2d_world* world, sc2d_shape* shape) {
+	int vert_count = (shape->type == SC2D_SHAPE_POLY) ? shape->count : 0;
+	if (world->free_slot == -1 && world->slot_count == world->capacity) return 0;
+
+	if (world->vert_used + vert_count > world->vert_capacity) {
+		if (world->vert_used - world->vert_free + vert_count > world->vert_capacity) return 0;
+		world_compact_verts(world);
+	}
+
+	int slot = world->free_slot;
+	if (slot != -1) {
+		world->free_slot = world->proxy[slot];
+	} else {
+		slot = world->slot_count++;
+		world->flags[slot] = 0;
+	}
+
+	world->type[slot] = (unsigned char)shape->type;
+	world->x[slot] = shape->x;
+	world->y[slot] = shape->y;
+	world->w[slot] = shape->w;
+	world->h[slot] = shape->h;
+	world->r[slot] = shape->r;
+	world->vert_offset[slot] = world->vert_used;
+	world->vert_count[slot] = vert_count;
+
+	if (vert_count > 0) {
+		float* dst = world->verts + (size_t)world->vert_used * world->vert_stride;
+		if (shape->packed) {
+			sc2d_verts src = packed_view(shape->verts, vert_count), arena = v2_view(dst, vert_count);
+			for (int i = 0; i < vert_count; i++) {
+				*(float*)((char*)dst + (ptrdiff_t)i * arena.stride + arena.offset_x) = vert_x(&src, i);
+				*(float*)((char*)dst + (ptrdiff_t)i * arena.stride + arena.offset_y) = vert_y(&src, i);
+			}
+		} else {
+			for (int i = 0; i < vert_count * world->vert_stride; i++) dst[i] = shape->verts[i];
+		}
+
+		world->vert_owner[world->vert_used] = slot;
+		world->vert_used += vert_count;
+	}
+
+	float* bounds = world->bounds + 4 * slot;
+	world_local_bounds(world, slot, world->local_bounds + 4 * slot);
+	world_update_bounds(world, slot);
+	world->proxy[slot] = sc2d_bvh_insert(&world->bvh, slot, bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
+
+	world->moved_step[slot] = world->step;
+	world_mark_dirty(world, slot, SC2D_WORLD_ADDED | SC2D_WORLD_REINSERTED);
+	world_add_awake(world, slot);
+
+	world->shape_count++;
+	return world_handle(world, slot);
+}
+
+// Remove a shape. Its handle, and any copy of it, becomes invalid. Stale handles are ignored.
+// Removing a sleeping shape wakes its island, since the shapes it held up may start to move.
+void sc2d_world_remove(sc2d_world* world, sc2d_handle handle) {
+	int slot = world_slot(world, handle);
+	if (slot == -1) return;
+
+	world_wake_island(world, slot);
+	world_remove_awake(world, slot);
+	sc2d_bvh_remove(&world->bvh, world->proxy[slot]);
+
+	int offset = world->vert_offset[slot], count = world->vert_count[slot];
+	if (count > 0) {
+		if (offset + count == world->vert_used) {
+			world->vert_used = offset;
+		} else {
+			world->vert_owner[offset] = -1 - count;
+			world->vert_free += count;
+		}
+	}
+
+	world->generation[slot] = (world->generation[slot] + 1) & SC2D_WORLD_GENERATION_MASK;
+	if (world->generation[slot] == 0) world->generation[slot] = 1;
+
+	// A dirty slot stays in the dirty list until the next step, which skips it if it is still free
+	world->flags[slot] &= SC2D_WORLD_DIRTY;
+	world->type[slot] = SC2D_WORLD_FREE;
+	world->proxy[slot] = world->free_slot;
+	world->free_slot = slot;
+	world->shape_count--;
+}
+
+// Check if a handle refers to a shape in the world
+bool sc2d_world_valid(sc2d_world* world, sc2d_handle handle) {
+	return world_slot(world, handle) != -1;
+}
+
+// Move a shape to a new position (same meaning as sc2d_shape x and y). Stale handles are ignored.
+// Moving a sleeping shape wakes its island. Moves to the current position cost nothing.
+void sc2d_world_move(sc2d_world* world, sc2d_handle handle, float x, float y) {
+	int slot = world_slot(world, handle);
+	if (slot == -1) return;
+
+	float delta_x = x - world->x[slot];
+	float delta_y = y - world->y[slot];
+	if (delta_x == 0 && delta_y == 0) return;
+
+	world_wake_island(world, slot);
+	if (delta_x * delta_x + delta_y * delta_y > SC2D_WORLD_SLEEP_MOTION * SC2D_WORLD_SLEEP_MOTION) {
+		world->moved_step[slot] = world->step;
+	}
+
+	world->x[slot] = x;
+	world->y[slot] = y;
+	world_update_bounds(world, slot);
+
+	float* bounds = world->bounds + 4 * slot;
+	bool reinserted = sc2d_bvh_move(&world->bvh, world->proxy[slot], bounds[0], bounds[1], bounds[2] - bounds[0], bounds[3] - bounds[1]);
+	world_mark_dirty(world, slot, reinserted ? SC2D_WORLD_REINSERTED : 0);
+}
+
+// Copy a shape out of the world. Returns false for stale handles.
+// Polygon vertices point into the arena, which sc2d_world_add may compact, so they are valid until the next add.
+bool sc2d_world_get(sc2d_world* world, sc2d_handle handle, sc2d_shape* shape) {
+	int slot = world_slot(world, handle);
+	if (slot == -1) return false;
+
+	world_shape(world, slot, shape);
+	return true;
+}
+
+// Check if a shape is asleep. Sleeping shapes don't need to be moved, and steps skip them.
+bool sc2d_world_sleeping(sc2d_world* world, sc2d_handle handle) {
+	int slot = world_slot(world, handle);
+	return slot != -1 && (world->flags[slot] & SC2D_WORLD_SLEEPING);
+}
+
+// Wake a sleeping shape and its island, for example when a force is applied to it
+void sc2d_world_wake(sc2d_world* world, sc2d_handle handle) {
+	int slot = world_slot(world, handle);
+	if (slot != -1) world_wake_island(world, slot);
+}
+
+// Find every colliding pair of shapes
+// The world keeps every pair whose BVH leaf bounds overlap. Pairs are tested (exact bounds check, then sc2d_collide)
+// when they are new or one of their shapes moved, and keep their last result otherwise. Only shapes that left their
+// leaf bounds query the BVH for new pairs. Pairs of sleeping shapes wait at the start of the pair list with their hits
+// at the start of the hit buffer, and steps skip them until an island wakes. So a step costs a pass over the pairs of
+// awake shapes plus the work for moved shapes.
+// Points hits at the world's hit buffer and returns the number of hits. Each pair is reported once, with a below b
+// in slot order. world->dropped counts the pairs lost to a full pair buffer.
+int sc2d_world_step(sc2d_world* world, sc2d_world_hit** hits) {
+	unsigned char* flags = world->flags;
+	int reinserted_count = 0;
+
+	// After a wake the set aside pairs may have awake shapes, so every pair is walked and set aside again
+	bool resort = world->woke;
+	if (resort) {
+		world->sleeping_pair_count = 0;
+		world->sleeping_hit_count = 0;
+	}
+	int pair_count = world->sleeping_pair_count;
+
+	world->step++;
+	world->test_count = 0;
+	world->dropped = 0;
+
+	for (int i = 0; i < world->dirty_count; i++) {
+		if (flags[world->dirty[i]] & SC2D_WORLD_REINSERTED) reinserted_count++;
+	}
+	bool rebuild = reinserted_count > world->shape_count / SC2D_WORLD_REBUILD_SHARE;
+
+	// Drop the pairs of removed shapes and of leaves that stopped overlapping, and retest the pairs of moved shapes
+	for (int i = world->sleeping_pair_count; i < world->pair_count; i++) {
+		sc2d_world_pair pair = world->pairs[i];
+		unsigned char pair_flags = flags[pair.a] | flags[pair.b];
+		bool gone = world->type[pair.a] == SC2D_WORLD_FREE || world->type[pair.b] == SC2D_WORLD_FREE || (pair_flags & SC2D_WORLD_ADDED);
+
+		if (!gone && (pair_flags & SC2D_WORLD_REINSERTED)) {
+			gone = !bvh_overlap(world->bvh.nodes + world->proxy[pair.a], world->bvh.nodes + world->proxy[pair.b]);
+		}
+
+		if (gone) {
+			// Sleeping shapes that may have lost a contact wake up
+			if (pair.hit) {
+				world_wake_island(world, pair.a);
+				world_wake_island(world, pair.b);
+			}
+			continue;
+		}
+
+		if (pair_flags & SC2D_WORLD_DIRTY) world_test_pair(world, &pair, true);
+		world->pairs[pair_count++] = pair;
+	}
+	world->pair_count = pair_count;
+
+	// Add the new pairs of shapes that left their leaf bounds. Pairs whose leaves overlapped at the last step are
+	// already in the list with their last result, unless one of the shapes is new.
+	if (rebuild) {
+		int count = sc2d_bvh_query_pairs(&world->bvh, &world->bvh, world->candidates, world->pair_capacity);
+		if (count < 0) {
+			world->dropped++;
+			count = 0;
+		} else if (count > world->pair_capacity) {
+			world->dropped += count - world->pair_capacity;
+			count = world->pair_capacity;
+		}
+
+		for (int i = 0; i < count; i++) {
+			int a = world->candidates[i].a, b = world->candidates[i].b;
+			if (!((flags[a] | flags[b]) & SC2D_WORLD_ADDED) && world_leaves_overlapped(world, a, b)) continue;
+
+			world_add_pair(world, a, b);
+		}
+	} else {
+		// One shape's results, as ints in the candidate pairs
+		int* results = (int*)world->candidates;
+		int result_capacity = 2 * world->pair_capacity;
+
+		for (int i = 0; i < world->dirty_count; i++) {
+			int slot = world->dirty[i];
+			if (!(flags[slot] & SC2D_WORLD_REINSERTED)) continue;
+
+			int count = bvh_query_bounds(&world->bvh, world->bvh.nodes + world->proxy[slot], results, result_capacity);
+			if (count < 0) {
+				world->dropped++;
+				count = 0;
+			} else if (count > result_capacity) {
+				world->dropped += count - result_capacity;
+				count = result_capacity;
+			}
+
+			for (int j = 0; j < count; j++) {
+				int other = results[j];
+				if (other == slot) continue;
+
+				// Pairs of two reinserted shapes are added from the lower slot
+				if ((flags[other] & SC2D_WORLD_REINSERTED) && other < slot) continue;
+				if (!((flags[slot] | flags[other]) & SC2D_WORLD_ADDED) && world_leaves_overlapped(world, slot, other)) continue;
+
+				world_add_pair(world, slot, other);
+			}
+		}
+	}
+
+	for (int i = 0; i < world->dirty_count; i++) {
+		int slot = world->dirty[i];
+
+		if (world->type[slot] != SC2D_WORLD_FREE && (flags[slot] & SC2D_WORLD_REINSERTED)) {
+			sc2d_bvh_node* leaf = world->bvh.nodes + world->proxy[slot];
+			float* bounds = world->leaf_bounds + 4 * slot;
+			bounds[0] = leaf->min_x;
+			bounds[1] = leaf->min_y;
+			bounds[2] = leaf->max_x;
+			bounds[3] = leaf->max_y;
+		}
+		flags[slot] &= ~(SC2D_WORLD_DIRTY | SC2D_WORLD_ADDED | SC2D_WORLD_REINSERTED);
+	}
+	world->dirty_count = 0;
+
+	bool fell_asleep = (SC2D_WORLD_SLEEP_STEPS > 0) && world_sleep_islands(world);
+
+	// Set aside the pairs whose shapes both sleep now, with their hits
+	if (resort || fell_asleep) {
+		for (int i = world->sleeping_pair_count; i < world->pair_count; i++) {
+			sc2d_world_pair pair = world->pairs[i];
+			if (!(flags[pair.a] & flags[pair.b] & SC2D_WORLD_SLEEPING)) continue;
+
+			world->pairs[i] = world->pairs[world->sleeping_pair_count];
+			world->pairs[world->sleeping_pair_count++] = pair;
+			if (pair.hit) world_store_hit(world, world->hits + world->sleeping_hit_count++, &pair);
+		}
+	}
+
+	// Every wake so far happened before the pairs were set aside again
+	if (resort) world->woke = false;
+
+	int hit_count = world->sleeping_hit_count;
+	for (int i = world->sleeping_pair_count; i < world->pair_count; i++) {
+		sc2d_world_pair* pair = world->pairs + i;
+		if (pair->hit) world_store_hit(world, world->hits + hit_count++, pair);
+	}
+
+	world->hit_count = hit_count;
+	*hits = world->hits;
+	return hit_count;
+}
+
+#ifdef SIMPLE_COLLISION_2D_THREADS
+
+// Pairs per chunk never drop below this, so small jobs are not split into tiny pieces
+#ifndef SC2D_MIN_CHUNK_SIZE
+#define SC2D_MIN_CHUNK_SIZE 64
+#endif
+
+// Run the chunks of one worker's range, then steal from the other ranges until every chunk is taken
+// Chunk c writes its hits to hits + c * chunk_size, which no other chunk touches.
+static void pool_run(sc2d_pool* pool, int index) {
+	for (int offset = 0; offset < pool->thread_count; offset++) {
+		sc2d_pool_range* range = pool->ranges + (index + offset) % pool->thread_count;
+
+		for (;;) {
+			long chunk = sc2d_atomic_fetch_add(&range->next, 1);
+			if (chunk >= range->end) break;
+
+			int first = (int)chunk * pool->chunk_size;
+			int count = pool->pair_count - first;
+			if (count > pool->chunk_size) count = pool->chunk_size;
+
+			pool->chunk_hits[chunk] = sc2d_collide_pairs(pool->shapes, pool->pairs + first, count, pool->hits + first);
+		}
+	}
+}
+
+#ifdef _WIN32
+static DWORD WINAPI pool_thread(LPVOID parameter) {
+#else
+static void* pool_thread(void* parameter) {
+#endif
+	sc2d_pool* pool = ((sc2d_pool_worker*)parameter)->pool;
+	int index = ((sc2d_pool_worker*)parameter)->index;
+	int generation = 0;
+
+	for (;;) {
+		pool_lock(&pool->mutex);
+		while (!pool->stop && pool->generation == generation) pool_wait(&pool->start, &pool->mutex);
+		generation = pool->generation;
+		bool stop = pool->stop;
+		pool_unlock(&pool->mutex);
+
+		if (stop) break;
+
+		pool_run(pool, index);
+
+		pool_lock(&pool->mutex);
+		if (--pool->pending == 0) pool_signal(&pool->done);
+		pool_unlock(&pool->mutex);
+	}
+
+	return 0;
+}
+
+// Start a pool of thread_count threads: thread_count - 1 workers plus the thread that submits each job
+// The pool must stay at the same address until sc2d_pool_destroy. Returns false if a worker could not be started,
+// in which case the pool still works with the threads that did start.
+bool sc2d_pool_init(sc2d_pool* pool, int thread_count) {
+	bool result = true;
+
+	if (thread_count < 1) thread_count = 1;
+	if (thread_count > SC2D_MAX_THREADS) thread_count = SC2D_MAX_THREADS;
+
+	pool->thread_count = 1;
+	pool->generation = 0;
+	pool->pending = 0;
+	pool->stop = false;
+
+#ifdef _WIN32
+	InitializeCriticalSection(&pool->mutex);
+	InitializeCriticalSection(&pool->submit);
+	InitializeConditionVariable(&pool->start);
+	InitializeConditionVariable(&pool->done);
+#else
+	pthread_mutex_init(&pool->mutex, 0);
+	pthread_mutex_init(&pool->submit, 0);
+	pthread_cond_init(&pool->start, 0);
+	pthread_cond_init(&pool->done, 0);
+#endif
+
+	for (int i = 1; i < thread_count; i++) {
+		sc2d_pool_worker* worker = pool->workers + i;
+		worker->pool = pool;
+		worker->index = i;
+
+#ifdef _WIN32
+		pool->threads[i] = CreateThread(0, 0, pool_thread, worker, 0, 0);
+		if (!pool->threads[i]) {
+#else
+		if (pthread_create(pool->threads + i, 0, pool_thread, worker) != 0) {
+#endif
+			result = false;
+			break;
+		}
+		pool->thread_count++;
+	}
+
+	return result;
+}
+
+// Stop and join the worker threads
+void sc2d_pool_destroy(sc2d_pool* pool) {
+	pool_lock(&pool->mutex);
+	pool->stop = true;
+	pool_broadcast(&pool->start);
+	pool_unlock(&pool->mutex);
+
+	for (int i = 1; i < pool->thread_count; i++) {
+#ifdef _WIN32
+		WaitForSingleObject(pool->threads[i], INFINITE);
+		CloseHandle(pool->threads[i]);
+#else
+		pthread_join(pool->threads[i], 0);
+#endif
+	}
+
+#ifdef _WIN32
+	DeleteCriticalSection(&pool->mutex);
+	DeleteCriticalSection(&pool->submit);
+#else
+	pthread_mutex_destroy(&pool->mutex);
+	pthread_mutex_destroy(&pool->submit);
+	pthread_cond_destroy(&pool->start);
+	pthread_cond_destroy(&pool->done);
+#endif
+	pool->thread_count = 0;
+}
+
+// Same as sc2d_collide_pairs, but spread over the threads of a pool
+// Every chunk of pairs writes its hits to its own part of hits, and the parts are then packed in chunk order,
+// so the output is identical to sc2d_collide_pairs for any thread count. Jobs from several threads run one at a time.
+// hits must have room for pair_count results. Returns the number of hits written.
+int sc2d_collide_pairs_parallel(sc2d_pool* pool, sc2d_shape* shapes, sc2d_pair* pairs, int pair_count, sc2d_hit* hits) {
+	int hit_count = 0;
+
+	if (pool->thread_count <= 1 || pair_count <= SC2D_MIN_CHUNK_SIZE) {
+		return sc2d_collide_pairs(shapes, pairs, pair_count, hits);
+	}
+
+	pool_lock(&pool->submit);
+
+	pool->shapes = shapes;
+	pool->pairs = pairs;
+	pool->hits = hits;
+	pool->pair_count = pair_count;
+	pool->chunk_size = (pair_count + SC2D_MAX_CHUNKS - 1) / SC2D_MAX_CHUNKS;
+	if (pool->chunk_size < SC2D_MIN_CHUNK_SIZE) pool->chunk_size = SC2D_MIN_CHUNK_SIZE;
+	pool->chunk_count = (pair_count + pool->chunk_size - 1) / pool->chunk_size;
+
+	// Give each thread an equal share of the chunks to start with
+	for (int i = 0; i < pool->thread_count; i++) {
+		pool->ranges[i].next = (long)((long long)pool->chunk_count * i / pool->thread_count);
+		pool->ranges[i].end = (long)((long long)pool->chunk_count * (i + 1) / pool->thread_count);
+	}
+
+	pool_lock(&pool->mutex);
+	pool->generation++;
+	pool->pending = pool->thread_count - 1;
+	pool_broadcast(&pool->start);
+	pool_unlock(&pool->mutex);
+
+	pool_run(pool, 0);
+
+	pool_lock(&pool->mutex);
+	while (pool->pending > 0) pool_wait(&pool->done, &pool->mutex);
+	pool_unlock(&pool->mutex);
+
+	// Pack the chunks' hits together in order
+	for (int chunk = 0; chunk < pool->chunk_count; chunk++) {
+		sc2d_hit* chunk_hits = hits + chunk * pool->chunk_size;
+		for (int i = 0; i < pool->chunk_hits[chunk]; i++) {
+			hits[hit_count++] = chunk_hits[i];
+		}
+	}
+
+	pool_unlock(&pool->submit);
+
+	return hit_count;
+}
+
+#endif
+
 #endif
@@ -0,0 +1,283 @@
+// Simple Collision 2D, C++ layer
+// Shape types and sc2d::collide<A, B>(), resolved at compile time, over the C functions in sc2d.h.
+// Define SIMPLE_COLLISION_2D_IMPLEMENTATION in one translation unit before including this header (or sc2d.h).
+
+#ifndef SIMPLE_COLLISION_2D_HPP
+
+#define SIMPLE_COLLISION_2D_HPP
+#include "sc2d.h"
+
+namespace sc2d {
+
+// Shapes, with the same conventions as the C functions
+struct point { float x, y; };
+struct circle { float x, y, r; };
+struct rect { float x, y, w, h; };				// Left x, top y, width, height
+struct capsule { float x, y, w, h, r; };		// Segment from (x - w, y - h) to (x + w, y + h)
+struct poly2d { float x, y; float* verts; int count; bool packed; };	// count x/y pairs (or custom sc2d_v2 structs unless packed), relative to (x, y)
+struct poly { float x, y; sc2d_poly* shape; };	// Built with sc2d_poly_init
+
+// Vertex layout of poly2d, the one sc2d_check_poly2d reads
+#ifdef SIMPLE_COLLISION_2D_VECTOR2
+typedef sc2d_v2 vertex;
+#else
+struct vertex { float x, y; };
+#endif
+
+inline sc2d_verts view(const poly2d& p) {
+	if (p.packed) {
+		sc2d_verts verts = {p.verts, (int)(2 * sizeof(float)), 0, (int)sizeof(float), p.count};
+		return verts;
+	}
+
+	sc2d_verts verts = {p.verts, (int)sizeof(vertex), (int)offsetof(vertex, x), (int)offsetof(vertex, y), p.count};
+	return verts;
+}
+
+inline sc2d_verts view(const poly& p) {
+	sc2d_verts verts = {p.shape->verts, (int)(2 * sizeof(float)), 0, (int)sizeof(float), p.shape->count};
+	return verts;
+}
+
+// Rect corners relative to the rect's position, in the layout of the strided views above
+struct rect_corners {
+	float verts[8];
+
+	explicit rect_corners(const rect& r) {
+		verts[0] = 0;   verts[1] = 0;
+		verts[2] = r.w; verts[3] = 0;
+		verts[4] = r.w; verts[5] = r.h;
+		verts[6] = 0;   verts[7] = r.h;
+	}
+
+	sc2d_verts view() {
+		sc2d_verts corners = {verts, (int)(2 * sizeof(float)), 0, (int)sizeof(float), 4};
+		return corners;
+	}
+};
+
+// Support function shapes for the GJK/EPA fallback
+inline sc2d_shape to_shape(const point& p) { sc2d_shape s = {SC2D_SHAPE_CIRCLE, p.x, p.y, 0, 0, 0, 0, 0, false}; return s; }
+inline sc2d_shape to_shape(const circle& c) { sc2d_shape s = {SC2D_SHAPE_CIRCLE, c.x, c.y, 0, 0, c.r, 0, 0, false}; return s; }
+inline sc2d_shape to_shape(const rect& r) { sc2d_shape s = {SC2D_SHAPE_RECT, r.x, r.y, r.w, r.h, 0, 0, 0, false}; return s; }
+inline sc2d_shape to_shape(const capsule& c) { sc2d_shape s = {SC2D_SHAPE_CAPSULE, c.x, c.y, c.w, c.h, c.r, 0, 0, false}; return s; }
+inline sc2d_shape to_shape(const poly2d& p) { sc2d_shape s = {SC2D_SHAPE_POLY, p.x, p.y, 0, 0, 0, p.verts, p.count, p.packed}; return s; }
+inline sc2d_shape to_shape(const poly& p) { sc2d_shape s = {SC2D_SHAPE_POLY, p.x, p.y, 0, 0, 0, p.shape->verts, p.shape->count, true}; return s; }
+
+// collider<A, B>::check is the narrowphase of one pair of shape types, with the overlap relative to a.
+// Each pair is specialized in one order. The other order swaps the arguments and flips the overlap, and pairs
+// without a specialization in either order fail to compile.
+template <class A, class B> struct collider {
+	static const bool specialized = false;
+
+	static bool check(const A& a, const B& b, float* overlap_x, float* overlap_y) {
+		static_assert(collider<B, A>::specialized, "sc2d::collide: no check for this pair of shape types");
+
+		bool hit = collider<B, A>::check(b, a, overlap_x, overlap_y);
+		if (hit) {
+			*overlap_x = -*overlap_x;
+			*overlap_y = -*overlap_y;
+		}
+		return hit;
+	}
+};
+
+template <> struct collider<point, circle> {
+	static const bool specialized = true;
+	static bool check(const point& a, const circle& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_point_circle(a.x, a.y, b.x, b.y, b.r, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<point, rect> {
+	static const bool specialized = true;
+	static bool check(const point& a, const rect& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_point_rect(a.x, a.y, b.x, b.y, b.w, b.h, overlap_x, overlap_y);
+	}
+};
+
+// The point checks of polygons only test containment, so hits take their overlap from a zero radius circle check
+template <> struct collider<point, poly2d> {
+	static const bool specialized = true;
+	static bool check(const point& a, const poly2d& b, float* overlap_x, float* overlap_y) {
+		sc2d_verts v2 = view(b);
+		if (!sc2d_check_point_poly2d_strided(a.x - b.x, a.y - b.y, &v2)) return false;
+
+		if (!sc2d_check_circle_poly2d_strided(a.x, a.y, 0, b.x, b.y, &v2, overlap_x, overlap_y)) *overlap_x = *overlap_y = 0;
+		return true;
+	}
+};
+
+template <> struct collider<point, poly> {
+	static const bool specialized = true;
+	static bool check(const point& a, const poly& b, float* overlap_x, float* overlap_y) {
+		if (!sc2d_check_point_poly(a.x, a.y, b.x, b.y, b.shape)) return false;
+
+		if (!sc2d_check_circle_poly(a.x, a.y, 0, b.x, b.y, b.shape, overlap_x, overlap_y)) *overlap_x = *overlap_y = 0;
+		return true;
+	}
+};
+
+template <> struct collider<circle, circle> {
+	static const bool specialized = true;
+	static bool check(const circle& a, const circle& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_circles(a.x, a.y, a.r, b.x, b.y, b.r, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<circle, rect> {
+	static const bool specialized = true;
+	static bool check(const circle& a, const rect& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_circle_rect(a.x, a.y, a.r, b.x, b.y, b.w, b.h, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<circle, poly2d> {
+	static const bool specialized = true;
+	static bool check(const circle& a, const poly2d& b, float* overlap_x, float* overlap_y) {
+		sc2d_verts v2 = view(b);
+		return sc2d_check_circle_poly2d_strided(a.x, a.y, a.r, b.x, b.y, &v2, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<circle, poly> {
+	static const bool specialized = true;
+	static bool check(const circle& a, const poly& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_circle_poly(a.x, a.y, a.r, b.x, b.y, b.shape, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<rect, rect> {
+	static const bool specialized = true;
+	static bool check(const rect& a, const rect& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_rects(a.x, a.y, a.w, a.h, b.x, b.y, b.w, b.h, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<rect, poly2d> {
+	static const bool specialized = true;
+	static bool check(const rect& a, const poly2d& b, float* overlap_x, float* overlap_y) {
+		rect_corners corners(a);
+		sc2d_verts v1 = corners.view(), v2 = view(b);
+		return sc2d_check_poly2d_strided(a.x, a.y, &v1, b.x, b.y, &v2, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<rect, poly> {
+	static const bool specialized = true;
+	static bool check(const rect& a, const poly& b, float* overlap_x, float* overlap_y) {
+		rect_corners corners(a);
+		sc2d_verts v1 = corners.view(), v2 = view(b);
+		return sc2d_check_poly2d_strided(a.x, a.y, &v1, b.x, b.y, &v2, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<poly2d, poly2d> {
+	static const bool specialized = true;
+	static bool check(const poly2d& a, const poly2d& b, float* overlap_x, float* overlap_y) {
+		sc2d_verts v1 = view(a), v2 = view(b);
+		return sc2d_check_poly2d_strided(a.x, a.y, &v1, b.x, b.y, &v2, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<poly2d, poly> {
+	static const bool specialized = true;
+	static bool check(const poly2d& a, const poly& b, float* overlap_x, float* overlap_y) {
+		sc2d_verts v1 = view(a), v2 = view(b);
+		return sc2d_check_poly2d_strided(a.x, a.y, &v1, b.x, b.y, &v2, overlap_x, overlap_y);
+	}
+};
+
+template <> struct collider<poly, poly> {
+	static const bool specialized = true;
+	static bool check(const poly& a, const poly& b, float* overlap_x, float* overlap_y) {
+		return sc2d_check_polys(a.x, a.y, a.shape, b.x, b.y, b.shape, overlap_x, overlap_y);
+	}
+};
+
+// Capsules have no dedicated checks: GJK/EPA against any shape, like sc2d_collide
+template <class B> struct collider<capsule, B> {
+	static const bool specialized = true;
+	static bool check(const capsule& a, const B& b, float* overlap_x, float* overlap_y) {
+		sc2d_shape s1 = to_shape(a), s2 = to_shape(b);
+		return sc2d_check_shapes(&s1, &s2, overlap_x, overlap_y);
+	}
+};
+
+// Check for collision between two shapes and return the overlap relative to a by reference
+template <class A, class B> inline bool collide(const A& a, const B& b, float* overlap_x, float* overlap_y) {
+	return collider<A, B>::check(a, b, overlap_x, overlap_y);
+}
+
+// Homogeneous batch: every pair indexes a in a and b in b, so each pair calls the check directly
+// Writes the colliding pairs to hits and returns their number, like sc2d_collide_pairs.
+template <class A, class B> int collide_pairs(const A* a, const B* b, const sc2d_pair* pairs, int pair_count, sc2d_hit* hits) {
+	int hit_count = 0;
+
+	for (int i = 0; i < pair_count; i++) {
+		sc2d_hit* hit = hits + hit_count;
+
+		if (collider<A, B>::check(a[pairs[i].a], b[pairs[i].b], &hit->overlap_x, &hit->overlap_y)) {
+			hit->a = pairs[i].a;
+			hit->b = pairs[i].b;
+			hit_count++;
+		}
+	}
+
+	return hit_count;
+}
+
+// C++ type of each runtime shape type (SC2D_SHAPE_*)
+template <int type> struct shape_type;
+
+template <> struct shape_type<SC2D_SHAPE_CIRCLE> {
+	typedef circle type;
+	static circle from(const sc2d_shape& s) { circle c = {s.x, s.y, s.r}; return c; }
+};
+
+template <> struct shape_type<SC2D_SHAPE_RECT> {
+	typedef rect type;
+	static rect from(const sc2d_shape& s) { rect r = {s.x, s.y, s.w, s.h}; return r; }
+};
+
+template <> struct shape_type<SC2D_SHAPE_CAPSULE> {
+	typedef capsule type;
+	static capsule from(const sc2d_shape& s) { capsule c = {s.x, s.y, s.w, s.h, s.r}; return c; }
+};
+
+template <> struct shape_type<SC2D_SHAPE_POLY> {
+	typedef poly2d type;
+	static poly2d from(const sc2d_shape& s) { poly2d p = {s.x, s.y, s.verts, s.count, s.packed}; return p; }
+};
+
+typedef bool (*collide_function)(const sc2d_shape& s1, const sc2d_shape& s2, float* overlap_x, float* overlap_y);
+
+template <int A, int B> bool collide_types(const sc2d_shape& s1, const sc2d_shape& s2, float* overlap_x, float* overlap_y) {
+	return collider<typename shape_type<A>::type, typename shape_type<B>::type>::check(
+		shape_type<A>::from(s1), shape_type<B>::from(s2), overlap_x, overlap_y);
+}
+
+// Runtime-typed shapes: one table lookup instead of a switch per shape, then the same checks as collide<A, B>
+// Same results as sc2d_collide, except that rect/polygon pairs use SAT where sc2d_collide uses GJK/EPA.
+// Shapes with a type outside SC2D_SHAPE_* never collide.
+inline bool collide(const sc2d_shape& s1, const sc2d_shape& s2, float* overlap_x, float* overlap_y) {
+	#define SC2D_COLLIDE_ROW(A) { \
+		&collide_types<A, SC2D_SHAPE_CIRCLE>, &collide_types<A, SC2D_SHAPE_RECT>, \
+		&collide_types<A, SC2D_SHAPE_CAPSULE>, &collide_types<A, SC2D_SHAPE_POLY> }
+
+	static const collide_function table[4][4] = {
+		SC2D_COLLIDE_ROW(SC2D_SHAPE_CIRCLE),
+		SC2D_COLLIDE_ROW(SC2D_SHAPE_RECT),
+		SC2D_COLLIDE_ROW(SC2D_SHAPE_CAPSULE),
+		SC2D_COLLIDE_ROW(SC2D_SHAPE_POLY)
+	};
+
+	#undef SC2D_COLLIDE_ROW
+
+	if ((unsigned int)s1.type >= 4 || (unsigned int)s2.type >= 4) return false;
+	return table[s1.type][s2.type](s1, s2, overlap_x, overlap_y);
+}
+
+}
+
+#endif